@@ -29,6 +29,8 @@
 
 #include "NexRv.h"      // For Nexus_TypeAddr
 #include "NexRvInfo.h"  // For 'InfoInit/InfoTerm'
+#include "NexRvCov.h"   // For 'Cov_Read/Cov_Write/Cov_Report'
+#include "NexRvFile.h"  // For 'NexRvFile_Seconds'
 
 // #define WITH_EXT 1      // Enable (in code, not by -DWITH_EXT=1 command line)
 
@@ -39,8 +41,11 @@
 FILE *fNex  = NULL;     // Used by NexusDump/NexusDeco/NexusEnco
 
 extern int NexusDump(FILE *f, int disp);
-extern int NexusDeco(FILE *f, int disp);
+extern int NexusDeco(FILE *f, int disp, uint64_t *pInstr);
+extern int NexusDecoFast(int withInfo, int disp, uint64_t *pCount);
+extern int NexusIndex(FILE *fIdx, int disp, uint64_t *pInstr);
 extern int NexusEnco(FILE *f, int level, int disp);
+extern int NexusEncoSrc(FILE *f[], int nSrc, int level, int disp);
 #if WITH_EXT
 extern int ExtProcess(int argc, char *argv[]);
 #endif
@@ -48,113 +53,89 @@ extern int ExtProcess(int argc, char *argv[]);
 extern int ConvGnuObjdump(FILE *fObjd, FILE *fPcInfo);
 extern int ConvAddInfo(FILE *fIn, FILE *fOut, FILE *fComp);
 extern int ConvRtlTrace(FILE *fIn, FILE *fOut);
+extern int ConvPcBin(FILE *fIn, FILE *fOut);
+extern int ConvPcsBin(FILE *fIn, FILE *fOut);
 
 int conf_Repeat = 0;        // 0=no repeat, 1=releat branch only, 2=repeat history
+int conf_PcBin  = 0;        // 1=binary PCOUT file (see NexRvPcBin.h)
+int conf_Sync   = 0;        // Periodic sync (after N instructions), 0=only first message is sync
+int conf_Tstamp = 0;        // TSTAMP in sync messages and after N cycles (since previous TSTAMP), 0=none
+int conf_Jobs   = 1;        // Number of decoder threads (trace is split at sync messages)
+int conf_nSrc   = 0;        // Number of SRC bits (multi-hart trace), 0=no SRC field
+int conf_Resync = 0;        // 1=continue after errors (from next sync message)
+int conf_SeqJump = 0;       // 1=sequential jumps (LUI/AUIPC + JR/JALR) are not reported (-seqjump)
+int conf_MsbExt  = 0;       // 1=identical MSB bits of addresses are skipped (-msbext, trTeInstExtendAddrMSB)
+int conf_IcntBits = 0;      // Size of I-CNT counter of encoder (-icnt), 0=unlimited (no I-CNT overflow)
+const char *conf_Profile = NULL;    // Profile file (-profile), no PCOUT then
+const char *conf_Folded  = NULL;    // Folded-stack file (-folded), no PCOUT then
+const char *conf_Coverage = NULL;   // Coverage file (-coverage), no PCOUT then
+const char *conf_Ipc = NULL;        // IPC report (-ipc), no PCOUT then
+uint64_t conf_Window = 100000;      // Time window of IPC report (cycles, see -window)
+
+const char *conf_PcOut = NULL;      // PCOUT file name (-src-bits decoder writes file per hart)
+
+const char *conf_Index = NULL;      // Index file (sync messages, see -index)
+uint64_t conf_From    = 0;          // First instruction to decode (-from)
+uint64_t conf_Offset  = ~(uint64_t)0; // Decode from sync before this offset (-offset)
+uint64_t conf_Count   = 0;          // Number of instructions to decode (0=all)
 
 #if 1 // Callstack related
 
-#define CALLSTACK_MAX 32    // Max depth
-
 int conf_CallStack = 0;     // =0: No support for call stack
 // int conf_CallStack = -8;    // <0: Callstack without a stack (just a counter). Max -N entries.
 // int conf_CallStack = 8;     // >0: Call-stack 'N' entries deep (with storing of an address).
+// Call-stack itself is in NexRvCallStack.c
 
-Nexus_TypeAddr callStack[CALLSTACK_MAX] = {0};
-int callStackTop = 0;
-int callStackCnt = 0;
-int callStackMax = 0;
+#endif
 
-void CallStack_Init()
+static int error(const char *err)
 {
-  callStackCnt = 0;
-  callStackTop = 0;
-  callStack[0] = 0; // Needed for logging with 'no-stack'
-  if (conf_CallStack >= 0)
-  {
-    callStackMax = conf_CallStack;
-  }
-  else
-  {
-    callStackMax = -conf_CallStack;
-  }
+  printf("\n");
+  printf("NexRv ERROR: %s\n", err);
+  return 9;
 }
 
-void CallStack_Push(Nexus_TypeAddr ret)
+// For use externally (nicer name)
+int NexRv_error(const char *err)
 {
-  if (0) printf("CallPush[%d] 0x%lX\n", callStackCnt + 1, ret);
-
-  if (conf_CallStack <= 0)
-  {
-    // Callstack without storing addresses (just saturating +- counter)
-    if (callStackCnt < callStackMax)
-    {
-      callStackCnt++; // Count (saturating at callStackMax)
-    }
-
-    return;
-  }
-
-  // Adjust 'top' (with wrap-around)
-  if (callStackTop >= callStackMax)
-  {
-    callStackTop = 0; // Wrap-around
-  }
-  else
-  {
-    callStackTop++;   // Just next
-  }
-
-  //Store (in new top)
-  callStack[callStackTop] = ret;
-
-  // Calculate new size (saturating)
-  if (callStackCnt < callStackMax)
-  {
-    callStackCnt++;
-  }
+  return error(err);
 }
 
-Nexus_TypeAddr CallStack_Pop()
+// Parse decimal or 0x-hex 64-bit number (returns 0 if not valid)
+static int ParseU64(const char *t, uint64_t *pV)
 {
-  if (0) printf("CallPop[%d] 0x%lX\n", callStackCnt, callStack[callStackTop]);
-
-  // Calculate new size (and handle empty)
-  if (callStackCnt == 0) return 1;  // Empty ('1' will never match 'real PC'!
-  callStackCnt--;
-
-  if (conf_CallStack <= 0)
-  {
-    return 0; // Any non-empty address (it will NOT be compared)
-  }
-
-  int prevTop = callStackTop;
-
-  // Adjust 'top' (with wrap-around)
-  if (callStackTop == 0)
-  {
-    callStackTop = (callStackMax - 1);  // Wrap around
-  }
-  else
-  {
-    callStackTop--;                     // Just previous
-  }
-
-  return callStack[prevTop];  // Return element on top (before adjustment)
+  char *e;
+  if (t == NULL || t[0] == '-') return 0;
+  *pV = (uint64_t)strtoull(t, &e, 0);
+  return (e != t && *e == '\0');
 }
 
-#endif
+// Parse value of -src-bits option (returns 0 if not valid)
+static int ParseSrcBits(int argc, char *argv[], int ai)
+{
+  if (ai + 1 >= argc || sscanf(argv[ai + 1], "%d", &conf_nSrc) != 1) return 0;
+  if (conf_nSrc < 0 || conf_nSrc > NEXUS_SRC_BITS_MAX) return 0;
+  printf("NexRv/Src: %d bits\n", conf_nSrc);
+  return 1;
+}
 
-static int error(const char *err)
+// Parse -cs option of decoder (depth of encoder call-stack). Decoder always
+// stores addresses (also for counter of encoder) and 0 keeps default depth.
+static int ParseDecoCallStack(int argc, char *argv[], int ai)
 {
-  printf("\n");
-  printf("NexRv ERROR: %s\n", err);
-  return 9;
+  int v;
+  if (ai + 1 >= argc || sscanf(argv[ai + 1], "%d", &v) != 1) return 0;
+  if (abs(v) > CALLSTACK_MAX) return 0;
+  if (v != 0) conf_CallStack = abs(v);
+  return 1;
 }
 
-// For use externally (nicer name)
-int NexRv_error(const char *err)
+// Default name of index file is <nex>.idx
+static const char *IndexName(const char *nexName)
 {
-  return error(err);
+  static char name[1024];
+  snprintf(name, sizeof(name), "%s.idx", nexName);
+  return name;
 }
 
 static int usage(const char *err)
@@ -166,20 +147,57 @@ static int usage(const char *err)
   printf("\n");
   printf("NexRv v1.0.0 (2025/01/02)\n");
   printf("Usage:\n");
-  printf("  NexRv -dump <nex> [<dump>] [-msg|-none] - dump Nexus file\n");
-  printf("  NexRv -deco <nex> -pcinfo <info> -pcout <pco> [-stat|-full|-all|-msg|-none] - decode trace\n");
-  printf("  NexRv -enco <pcseq> -nex <nex> [-nobhm|-norbm|-cs [<cs>]|-rpt <m>] [-stat|-full|-all|-msg|-none] - encode trace \n");
+  printf("  NexRv -dump <nex> [<dump>] [-msg|-none] [-src-bits <n>] - dump Nexus file\n");
+  printf("  NexRv -deco <nex> -pcinfo <info> -pcout <pco> [-pcbin|-j <n>|-src-bits <n>|-resync|-seqjump|-msbext|-cs <cs>] [-stat|-full|-all|-msg|-none] - decode trace\n");
+  printf("  NexRv -deco <nex> -pcinfo <info> -pcout <pco> [-idx <idx>] -from <i>|-offset <o> [-count <n>] ... - decode part of trace\n");
+  printf("  NexRv -deco <nex> -pcinfo <info> -pcout <pco> -process <id> <pinfo> [-process ...] [...] - decode trace of many processes\n");
+  printf("  NexRv -deco <nex> -stat-fast [-pcinfo <info>] - statistics only (I-CNT units, instructions with <info>)\n");
+  printf("  NexRv -deco <nex> -pcinfo <info> -profile <prof> [...] - flat profile of functions and blocks (no PCOUT)\n");
+  printf("  NexRv -deco <nex> -pcinfo <info> -folded <fold> [...] - folded call-stacks for flame graph (no PCOUT)\n");
+  printf("  NexRv -deco <nex> -pcinfo <info> -coverage <cov> [...] - instruction and branch coverage bitmaps (no PCOUT)\n");
+  printf("  NexRv -deco <nex> -pcinfo <info> -ipc <ipc> [-window <c>] [...] - cycles, instructions and IPC by time window and function (no PCOUT)\n");
+  printf("  NexRv -cov-merge <cov> <in>... - merge (OR) coverage files <in> of many runs to <cov>\n");
+  printf("  NexRv -cov-report <cov> -pcinfo <info> [-process <id> <pinfo>]... [<report>] - coverage of functions and partially covered branches\n");
+  printf("  NexRv -index <nex> -pcinfo <info> [-idx <idx>] [-process <id> <pinfo>]... [-seqjump|-msbext|-cs <cs>] [-stat|-none] - create index of sync messages\n");
+  printf("  NexRv -enco <pcseq> -nex <nex> [-nobhm|-norbm|-cs [<cs>]|-rpt <m>|-sync <n>|-tstamp <c>|-icnt <b>|-seqjump|-msbext] [-stat|-full|-all|-msg|-none] - encode trace \n");
+  printf("  NexRv -enco <pcseq> -nex <nex> -src-bits <n> [-hart <pcseq>]... [...] - encode trace of many harts\n");
   printf("  NexRv -conv -objd <objd> -pcinfo <pci> - create <pci> from objdump -d output <objd>\n");
   printf("  NexRv -conv -pcinfo <pci> -pconly <pco> -pcseq <pcs> - convert <pco> to <pcs> using <pci>\n");
   printf("  NexRv -conv -rtl <rtl> -pconly <pco> -  create <pco> file from <rtl> trace file\n");
-  printf("  NexRv -diff -pcseq <pcs> -pcout <pco> - compare <pcs> with <pco>\n");
+  printf("  NexRv -conv -pcbin <pcb> -pconly <pco> - convert binary PCOUT <pcb> to text <pco>\n");
+  printf("  NexRv -conv -pcseq <pcs> -pcsbin <psb> - convert <pcs> to binary PCSEQ <psb> (encoder input)\n");
+  printf("  NexRv -conv -pcinfo <pci> -pconly <pco> -pcsbin <psb> - convert <pco> to binary PCSEQ <psb> using <pci>\n");
+  printf("  NexRv -diff -pcseq <pcs> -pcout <pco> - compare <pcs> with <pco> (text or binary)\n");
 #if WITH_EXT
   printf("  NexRv -ext ... - extra processing (use -ext only to display extra usage)\n");
 #endif
   printf("where:\n");
   printf("  -nobhm|-norbm               - do not generate Branch History/Repeat Branch Messages\n");
-  printf("  -cs [<cs>]                  - enable call-stack level <cs> (0=none, 8 is default)\n");
+  printf("  -cs [<cs>]                  - enable call-stack level <cs> (0=none, 8 is default, max 4096, <0 is counter only)\n");
+  printf("                                (decoder and -index: depth used by encoder, if it is deeper than 32)\n");
   printf("  -rpt [<m>]                  - enable repeat detection (0=none,1=repeat branch,2=repeat history)\n");
+  printf("  -sync <n>                   - emit periodic sync message (after <n> instructions)\n");
+  printf("  -icnt <b>                    - encoder has <b>-bit I-CNT counter (%d..%d), ResourceFull (RCODE=0) is emitted before overflow\n", NEXUS_ICNT_BITS_MIN, NEXUS_ICNT_BITS_MAX);
+  printf("  -seqjump                    - sequential jump optimization: no message for 'jr/jalr' after 'lui/auipc' of its register\n");
+  printf("                                (target is in <info> - 'JS'/'CS' record, decoder and -index must use -seqjump as well)\n");
+  printf("  -msbext                     - skip identical MSB bits (1-s or 0-s) of U-ADDR/F-ADDR (last MDO bit is extended)\n");
+  printf("                                (virtual address optimization, decoder and -index must use -msbext as well)\n");
+  printf("  -tstamp <c>                 - emit TSTAMP in sync messages (absolute) and in messages <c>+ cycles after previous one (relative)\n");
+  printf("                                (cycle of instruction is '@<cycle>' at end of <pcseq> line, instruction number if not given)\n");
+  printf("  -pcbin                      - write binary PCOUT (PC deltas and repeats as varints)\n");
+  printf("  <pcseq>                     - text or binary PCSEQ (INFO byte and PC delta per instruction, see -conv ... -pcsbin)\n");
+  printf("  -j <n>                      - decode with <n> threads (trace is split at sync messages)\n");
+  printf("  <info>                      - PCINFO file or load-map file ('.loadmap' and '<image> <offset> <pcinfo>' lines)\n");
+  printf("  -process <id> <pinfo>       - code image of process <id> (PROCESS of Ownership message), <info> is for other processes\n");
+  printf("                                (-cov-report must use the same -process options as decoder of <cov>)\n");
+  printf("                                (encoder sends Ownership when '.process <id>' line of <pcseq> changes process)\n");
+  printf("  -window <c>                 - time window of -ipc report (100000 cycles is default)\n");
+  printf("  -resync                     - continue after error (skip to next sync message, report lost bytes)\n");
+  printf("  -idx <idx>                  - index file (<nex>.idx is default)\n");
+  printf("  -from <i>|-offset <o>       - decode from instruction <i> or from sync before file offset <o>\n");
+  printf("  -count <n>                  - decode <n> instructions only\n");
+  printf("  -src-bits <n>               - size of SRC field (PCOUT of each hart is <pco> with -<src> before extension)\n");
+  printf("  -hart <pcseq>               - PCSEQ of next hart (first hart is <pcseq>, SRC=0)\n");
   printf("  -stat|-full|-all|-msg|-none - verbose level\n");
 
 #if 0
@@ -223,8 +241,18 @@ int main(int argc, char *argv[])
     }
 
     int disp = 4 | 2 | 1; // Default (all)
-    if (argc > opt && strcmp(argv[opt], "-msg") == 0)   disp = 4 | 2; // TCODE and stat.
-    if (argc > opt && strcmp(argv[opt], "-none") == 0)  disp = 4;     // Only statistics
+    for (int ai = opt; ai < argc; ai++)
+    {
+      if (strcmp(argv[ai], "-msg") == 0)   disp = 4 | 2; // TCODE and stat.
+      else
+      if (strcmp(argv[ai], "-none") == 0)  disp = 4;     // Only statistics
+      else
+      if (strcmp(argv[ai], "-src-bits") == 0)
+      {
+        if (!ParseSrcBits(argc, argv, ai)) return error("-src-bits requires number of bits (0..8)");
+        ai++;
+      }
+    }
 
     int ret = NexusDump(fDump, disp);
     fclose(fNex); fNex = NULL;
@@ -239,6 +267,8 @@ int main(int argc, char *argv[])
   {
     // -conv -objd <objd> -pcinfo <pci>
     // -conv -pcinfo <pci> -pconly <pc> -pcseq <ps>
+    // -conv -pcinfo <pci> -pconly <pc> -pcsbin <psb>
+    // -conv -pcseq <ps> -pcsbin <psb>
     const char *err = "Incorrect -conv calling";
 
     int ret = 0;
@@ -285,6 +315,56 @@ int main(int argc, char *argv[])
         fclose(psFile);
         InfoTerm();
       }
+      else
+      if (strcmp(argv[4], "-pconly") == 0 && strcmp(argv[6], "-pcsbin") == 0)
+      {
+        // -conv -pcinfo <pci> -pconly <pc> -pcsbin <psb> (text PCSEQ is temporary file)
+        err = NULL;
+
+        if (InfoInit(argv[3]) < 0) return error("Cannot open PCINFO file");
+
+        FILE *pcFile = fopen(argv[5], "rt");
+        if (pcFile == NULL) return error("Cannot open PCONLY file");
+
+        FILE *tmpFile = tmpfile();
+        if (tmpFile == NULL) return error("Cannot create temporary file");
+
+        FILE *psbFile = fopen(argv[7], "wb");
+        if (psbFile == NULL) return error("Cannot create PCSBIN file");
+
+        // Run conversion
+        ret = ConvAddInfo(pcFile, tmpFile, NULL);
+        if (ret > 0)
+        {
+          rewind(tmpFile);
+          ret = ConvPcsBin(tmpFile, psbFile);
+        }
+        fclose(pcFile);
+        fclose(tmpFile);
+        fclose(psbFile);
+        InfoTerm();
+      }
+    }
+    else
+    if (argc == 6 && strcmp(argv[2], "-pcseq") == 0)
+    {
+      // -conv -pcseq <ps> -pcsbin <psb>
+      if (strcmp(argv[4], "-pcsbin") == 0)
+      {
+        // Syntax correct - open all files
+        err = NULL;
+
+        FILE *psFile = fopen(argv[3], "rt");
+        if (psFile == NULL) return error("Cannot open PCSEQ file");
+
+        FILE *psbFile = fopen(argv[5], "wb");
+        if (psbFile == NULL) return error("Cannot create PCSBIN file");
+
+        // Run conversion
+        ret = ConvPcsBin(psFile, psbFile);
+        fclose(psbFile);
+        fclose(psFile);
+      }
     }
     else
     if (argc == 6 && strcmp(argv[2], "-rtl") == 0)
@@ -307,6 +387,27 @@ int main(int argc, char *argv[])
         fclose(rtlFile);
       }
     }
+    else
+    if (argc == 6 && strcmp(argv[2], "-pcbin") == 0)
+    {
+      // -conv -pcbin <pcb> -pconly <pco>
+      if (strcmp(argv[4], "-pconly") == 0)
+      {
+        // Syntax correct - open all files
+        err = NULL;
+
+        FILE *pcbFile = fopen(argv[3], "rb");
+        if (pcbFile == NULL) return error("Cannot open PCBIN file");
+
+        FILE *pcoFile = fopen(argv[5], "wt");
+        if (pcoFile == NULL) return error("Cannot create PCONLY file");
+
+        // Run conversion
+        ret = ConvPcBin(pcbFile, pcoFile);
+        fclose(pcoFile);
+        fclose(pcbFile);
+      }
+    }
 
     if (err != NULL) return usage(err);
 
@@ -341,7 +442,7 @@ int main(int argc, char *argv[])
         FILE *fPcseq = fopen(argv[3], "rt");
         if (fPcseq == NULL)  return error("Cannot open PCSEQ file");
 
-        FILE *fPcout = fopen(argv[5], "rt");
+        FILE *fPcout = fopen(argv[5], "rb");  // Binary, as it may be binary PCOUT
         if (fPcout == NULL) return error("Cannot open PCOUT file");
 
         // Run comparison
@@ -373,9 +474,13 @@ int main(int argc, char *argv[])
 
     if (strcmp(argv[3], "-nex") != 0) return error("-nex must be provided");
 
-    FILE *fPcseq = fopen(argv[2], "rt");
+    FILE *fPcseq = fopen(argv[2], "rb");  // Text or binary PCSEQ
     if (fPcseq == NULL)  return error("Cannot open PCSEQ file");
 
+    FILE *fHart[1 << NEXUS_SRC_BITS_MAX];  // PCSEQ of each hart (-hart)
+    int nHart = 1;
+    fHart[0] = fPcseq;
+
     fNex = fopen(argv[4], "wb");
     if (fNex == NULL) return error("Cannot create NEX file");
 
@@ -391,6 +496,10 @@ int main(int argc, char *argv[])
       else
       if (strcmp(argv[ai], "-norbm") == 0) level = 20;  // Level 2.0
       else
+      if (strcmp(argv[ai], "-seqjump") == 0) conf_SeqJump = 1;
+      else
+      if (strcmp(argv[ai], "-msbext") == 0) conf_MsbExt = 1;
+      else
       if (strcmp(argv[ai], "-cs") == 0) 
       {
         int v;
@@ -427,6 +536,52 @@ int main(int argc, char *argv[])
         printf("NexRv/Repeat: %d\n", conf_Repeat);
       }
       else
+      if (strcmp(argv[ai], "-sync") == 0)
+      {
+        if (ai + 1 >= argc || sscanf(argv[ai + 1], "%d", &conf_Sync) != 1 || conf_Sync < 0)
+        {
+          return error("-sync requires number of instructions");
+        }
+        ai++;
+        printf("NexRv/Sync: %d\n", conf_Sync);
+      }
+      else
+      if (strcmp(argv[ai], "-tstamp") == 0)
+      {
+        if (ai + 1 >= argc || sscanf(argv[ai + 1], "%d", &conf_Tstamp) != 1 || conf_Tstamp < 0)
+        {
+          return error("-tstamp requires number of cycles");
+        }
+        ai++;
+        printf("NexRv/Tstamp: %d\n", conf_Tstamp);
+      }
+      else
+      if (strcmp(argv[ai], "-icnt") == 0)
+      {
+        if (ai + 1 >= argc || sscanf(argv[ai + 1], "%d", &conf_IcntBits) != 1 ||
+            conf_IcntBits < NEXUS_ICNT_BITS_MIN || conf_IcntBits > NEXUS_ICNT_BITS_MAX)
+        {
+          return error("-icnt requires number of bits of I-CNT counter");
+        }
+        ai++;
+        printf("NexRv/Icnt: %d bits\n", conf_IcntBits);
+      }
+      else
+      if (strcmp(argv[ai], "-src-bits") == 0)
+      {
+        if (!ParseSrcBits(argc, argv, ai)) return error("-src-bits requires number of bits (0..8)");
+        ai++;
+      }
+      else
+      if (strcmp(argv[ai], "-hart") == 0)
+      {
+        if (ai + 1 >= argc) return error("-hart requires PCSEQ file");
+        if (nHart >= (1 << NEXUS_SRC_BITS_MAX)) return error("Too many -hart files");
+        fHart[nHart] = fopen(argv[++ai], "rb");
+        if (fHart[nHart] == NULL) return error("Cannot open PCSEQ file");
+        nHart++;
+      }
+      else
       if (strcmp(argv[ai], "-all") == 0)   disp = 4 | 2 | 1; // All
       else
       if (strcmp(argv[ai], "-msg") == 0)   disp = 4 | 2;     // TCODE and stat.
@@ -444,10 +599,20 @@ int main(int argc, char *argv[])
       ai++;
     }
 
+    if (nHart > (1 << conf_nSrc)) return error("Too many -hart files for -src-bits");
+
     if (level < 0) level = 21;  // Level 2.1 is default
-    int ret = NexusEnco(fPcseq, level, disp);
+    int ret;
+    if (conf_nSrc > 0)
+      ret = NexusEncoSrc(fHart, nHart, level, disp);
+    else
+      ret = NexusEnco(fPcseq, level, disp);
     fclose(fNex); fNex = NULL;
-    fclose(fPcseq); fPcseq = NULL;
+    for (int k = 0; k < nHart; k++)
+    {
+      fclose(fHart[k]);
+    }
+    fPcseq = NULL;
 
     if (ret > 0)
     {
@@ -463,36 +628,364 @@ int main(int argc, char *argv[])
     return ret;
   }
 
-  if (strcmp(argv[1], "-deco") == 0) // Decode?
+  if (strcmp(argv[1], "-index") == 0) // Index?
   {
-    conf_CallStack = CALLSTACK_MAX; // Always full call-stack
+    conf_CallStack = CALLSTACK_DEFAULT; // Same as decoder (-cs of encoder if it was deeper)
 
-    if (argc < 7) return error("Incorrect number of parameters");
+    if (argc < 5) return error("Incorrect number of parameters");
     if (strcmp(argv[3], "-pcinfo") != 0) return error("-pcinfo must be provided");
-    if (strcmp(argv[5], "-pcout") != 0) return error("-pcout must be provided");
+
+    const char *idxName = IndexName(argv[2]);
+    int disp = 4; // Default (-stat)
+    int nProc = 0;            // Code images of processes (-process)
+    uint64_t procId[INFO_PROCESS_MAX];
+    const char *procInfo[INFO_PROCESS_MAX];
+
+    // Process options
+    for (int ai = 5; ai < argc; ai++)
+    {
+      if (strcmp(argv[ai], "-idx") == 0 && ai + 1 < argc) idxName = argv[++ai];
+      else
+      if (strcmp(argv[ai], "-process") == 0)
+      {
+        if (nProc >= INFO_PROCESS_MAX) return error("Too many -process options");
+        if (ai + 2 >= argc || !ParseU64(argv[ai + 1], &procId[nProc]))
+        {
+          return error("-process requires process and PCINFO file");
+        }
+        procInfo[nProc++] = argv[ai + 2];
+        ai += 2;
+      }
+      else
+      if (strcmp(argv[ai], "-seqjump") == 0) conf_SeqJump = 1;
+      else
+      if (strcmp(argv[ai], "-msbext") == 0) conf_MsbExt = 1;
+      else
+      if (strcmp(argv[ai], "-cs") == 0)
+      {
+        if (!ParseDecoCallStack(argc, argv, ai)) return error("-cs requires depth of call-stack");
+        ai++;
+      }
+      else
+      if (strcmp(argv[ai], "-stat") == 0)  disp = 4;         // Only statistics
+      else
+      if (strcmp(argv[ai], "-none") == 0)  disp = 0;         // Nothing
+      else
+      {
+        printf("ERROR: Unknown option %s\n", argv[ai]);
+        return 10;
+      }
+    }
 
     fNex = fopen(argv[2], "rb");
     if (fNex == NULL) return error("Cannot open NEX file");
     if (InfoInit(argv[4]) < 0) return error("Cannot open PCINFO file");
-    FILE *fOut = fopen(argv[6], "wt");
-    if (fOut == NULL) return error("Cannot create PCOUT file");
+    for (int k = 0; k < nProc; k++)
+    {
+      if (InfoProcessAdd(procId[k], procInfo[k]) < 0) return error("Cannot open PCINFO file of -process (or process is repeated)");
+    }
+    FILE *fIdx = fopen(idxName, "wt");
+    if (fIdx == NULL) return error("Cannot create index file");
 
+    uint64_t nInstr = 0;
+    int ret = NexusIndex(fIdx, disp, &nInstr);
+    fclose(fIdx);
+    fclose(fNex); fNex = NULL;
+    InfoTerm();
 
-    int disp = 4; // Default (-stat)
-    if (argc > 7 && strcmp(argv[7], "-all") == 0)   disp = 4 | 2 | 1; // All
-    if (argc > 7 && strcmp(argv[7], "-msg") == 0)   disp = 4 | 2;     // TCODE and stat.
-    if (argc > 7 && strcmp(argv[7], "-stat") == 0)  disp = 4;         // Only statistics
-    if (argc > 7 && strcmp(argv[7], "-none") == 0)  disp = 0;         // Nothing
-    if (argc > 7 && strcmp(argv[7], "-full") == 0)  disp = 0xFF;      // Everything
+    if (ret >= 0)
+    {
+      printf("Indexed OK (%lu instructions)\n\n", nInstr);
+      ret = 0;
+    }
+    else
+    {
+      printf("ERROR: Indexing failed with error code #%d\n\n", -ret);
+      ret = 9;
+    }
+
+    return ret;
+  }
+
+  if (strcmp(argv[1], "-cov-merge") == 0) // Merge coverage files?
+  {
+    if (argc < 4) return error("Incorrect number of parameters");
 
-    int ret = NexusDeco(fOut, disp);
+    NexRvCov cov;
+    cov.bits = NULL;
+    double t = NexRvFile_Seconds();
+    for (int ai = 3; ai < argc; ai++)
+    {
+      FILE *fIn = fopen(argv[ai], "rb");
+      if (fIn == NULL)
+      {
+        printf("ERROR: Cannot open coverage file %s\n", argv[ai]);
+        Cov_Free(&cov);
+        return 9;
+      }
+      int r = Cov_Read(&cov, fIn);
+      fclose(fIn);
+      if (r < 0)
+      {
+        printf("ERROR: %s is %s\n", argv[ai], (r == -2) ? "for different PCINFO" : (r == -3) ? "too big" : "not a coverage file");
+        Cov_Free(&cov);
+        return 9;
+      }
+    }
+    t = NexRvFile_Seconds() - t;
+
+    FILE *fOut = fopen(argv[2], "wb");
+    if (fOut == NULL)
+    {
+      Cov_Free(&cov);
+      return error("Cannot create coverage file");
+    }
+    int ret = Cov_Write(&cov, fOut);
     fclose(fOut);
+    Cov_Free(&cov);
+    if (ret < 0) return error("Cannot write coverage file");
+
+    printf("NexRv/Coverage: %d files merged in %.3lf sec\n", argc - 3, t);
+    printf("Merged OK\n\n");
+    return 0;
+  }
+
+  if (strcmp(argv[1], "-cov-report") == 0) // Coverage report?
+  {
+    if (argc < 5) return error("Incorrect number of parameters");
+    if (strcmp(argv[3], "-pcinfo") != 0) return error("-pcinfo must be provided");
+
+    // Code images of processes must be the same as of decoding (-process)
+    const char *repName = NULL;
+    int nProc = 0;
+    uint64_t procId[INFO_PROCESS_MAX];
+    const char *procInfo[INFO_PROCESS_MAX];
+    for (int ai = 5; ai < argc; ai++)
+    {
+      if (strcmp(argv[ai], "-process") == 0)
+      {
+        if (nProc >= INFO_PROCESS_MAX) return error("Too many -process options");
+        if (ai + 2 >= argc || !ParseU64(argv[ai + 1], &procId[nProc]))
+        {
+          return error("-process requires process and PCINFO file");
+        }
+        procInfo[nProc++] = argv[ai + 2];
+        ai += 2;
+      }
+      else
+      if (repName == NULL) repName = argv[ai];
+      else return error("Incorrect number of parameters");
+    }
+
+    NexRvCov cov;
+    cov.bits = NULL;
+    FILE *fIn = fopen(argv[2], "rb");
+    if (fIn == NULL) return error("Cannot open coverage file");
+    int ret = Cov_Read(&cov, fIn);
+    fclose(fIn);
+    if (ret < 0) return error("Not a coverage file");
+    if (InfoInit(argv[4]) < 0)
+    {
+      Cov_Free(&cov);
+      return error("Cannot open PCINFO file");
+    }
+    for (int k = 0; k < nProc; k++)
+    {
+      if (InfoProcessAdd(procId[k], procInfo[k]) < 0)
+      {
+        Cov_Free(&cov);
+        InfoTerm();
+        return error("Cannot open PCINFO file of -process (or process is repeated)");
+      }
+    }
+
+    FILE *fRep = stdout;
+    if (repName != NULL)
+    {
+      fRep = fopen(repName, "wt");
+      if (fRep == NULL)
+      {
+        Cov_Free(&cov);
+        InfoTerm();
+        return error("Cannot create report file");
+      }
+    }
+    ret = Cov_Report(&cov, fRep, 4);
+    if (fRep != stdout) fclose(fRep);
+    Cov_Free(&cov);
+    InfoTerm();
+    if (ret < 0) return error("Coverage file is for different PCINFO");
+
+    printf("Reported OK\n\n");
+    return 0;
+  }
+
+  if (strcmp(argv[1], "-deco") == 0 && argc >= 4 && strcmp(argv[3], "-stat-fast") == 0) // Statistics only?
+  {
+    const char *infoName = NULL;
+    if (argc == 6 && strcmp(argv[4], "-pcinfo") == 0) infoName = argv[5];
+    else
+    if (argc != 4) return error("Incorrect number of parameters");
+
+    fNex = fopen(argv[2], "rb");
+    if (fNex == NULL) return error("Cannot open NEX file");
+    if (infoName != NULL && InfoInit(infoName) < 0) return error("Cannot open PCINFO file");
+
+    uint64_t cnt = 0;
+    int ret = NexusDecoFast(infoName != NULL, 4, &cnt);
+    fclose(fNex); fNex = NULL;
+    if (infoName != NULL) InfoTerm();
+
+    if (ret >= 0)
+    {
+      if (ret > 0) printf("Decoded OK (%lu instructions)\n\n", cnt);
+      else         printf("Decoded OK (%lu I-CNT units - halfwords)\n\n", cnt);
+      ret = 0;
+    }
+    else
+    {
+      printf("ERROR: Decoding failed with error code #%d\n\n", -ret);
+      ret = 9;
+    }
+
+    return ret;
+  }
+
+  if (strcmp(argv[1], "-deco") == 0) // Decode?
+  {
+    conf_CallStack = CALLSTACK_DEFAULT; // Full call-stack (-cs of encoder if it was deeper)
+
+    if (argc < 7) return error("Incorrect number of parameters");
+    if (strcmp(argv[3], "-pcinfo") != 0) return error("-pcinfo must be provided");
+    if (strcmp(argv[5], "-profile") == 0) conf_Profile = argv[6];  // Profile instead of PCOUT
+    else
+    if (strcmp(argv[5], "-folded") == 0) conf_Folded = argv[6];    // Folded stacks instead of PCOUT
+    else
+    if (strcmp(argv[5], "-coverage") == 0) conf_Coverage = argv[6]; // Coverage instead of PCOUT
+    else
+    if (strcmp(argv[5], "-ipc") == 0) conf_Ipc = argv[6];          // IPC report instead of PCOUT
+    else
+    if (strcmp(argv[5], "-pcout") != 0) return error("-pcout (or -profile/-folded/-coverage/-ipc) must be provided");
+
+    int disp = 4; // Default (-stat)
+    conf_PcBin = 0;
+    conf_Jobs = 1;
+
+    int nProc = 0;            // Code images of processes (-process)
+    uint64_t procId[INFO_PROCESS_MAX];
+    const char *procInfo[INFO_PROCESS_MAX];
+
+    // Process options
+    for (int ai = 7; ai < argc; ai++)
+    {
+      if (strcmp(argv[ai], "-pcbin") == 0) conf_PcBin = 1;
+      else
+      if (strcmp(argv[ai], "-resync") == 0) conf_Resync = 1;
+      else
+      if (strcmp(argv[ai], "-seqjump") == 0) conf_SeqJump = 1;
+      else
+      if (strcmp(argv[ai], "-msbext") == 0) conf_MsbExt = 1;
+      else
+      if (strcmp(argv[ai], "-cs") == 0)
+      {
+        if (!ParseDecoCallStack(argc, argv, ai)) return error("-cs requires depth of call-stack");
+        ai++;
+      }
+      else
+      if (strcmp(argv[ai], "-idx") == 0 && ai + 1 < argc) conf_Index = argv[++ai];
+      else
+      if (strcmp(argv[ai], "-from") == 0 || strcmp(argv[ai], "-offset") == 0 || strcmp(argv[ai], "-count") == 0)
+      {
+        uint64_t v;
+        if (ai + 1 >= argc || !ParseU64(argv[ai + 1], &v))
+        {
+          printf("ERROR: Option %s requires a number\n", argv[ai]);
+          return 10;
+        }
+        if (argv[ai][1] == 'f') conf_From = v;
+        if (argv[ai][1] == 'o') conf_Offset = v;
+        if (argv[ai][1] == 'c') conf_Count = v;
+        ai++;
+      }
+      else
+      if (strcmp(argv[ai], "-process") == 0)
+      {
+        if (nProc >= INFO_PROCESS_MAX) return error("Too many -process options");
+        if (ai + 2 >= argc || !ParseU64(argv[ai + 1], &procId[nProc]))
+        {
+          return error("-process requires process and PCINFO file");
+        }
+        procInfo[nProc++] = argv[ai + 2];
+        ai += 2;
+      }
+      else
+      if (strcmp(argv[ai], "-window") == 0)
+      {
+        if (ai + 1 >= argc || !ParseU64(argv[ai + 1], &conf_Window) || conf_Window == 0)
+        {
+          return error("-window requires number of cycles");
+        }
+        ai++;
+      }
+      else
+      if (strcmp(argv[ai], "-j") == 0)
+      {
+        if (ai + 1 >= argc || sscanf(argv[ai + 1], "%d", &conf_Jobs) != 1 || conf_Jobs < 1)
+        {
+          return error("-j requires number of threads");
+        }
+        ai++;
+      }
+      else
+      if (strcmp(argv[ai], "-src-bits") == 0)
+      {
+        if (!ParseSrcBits(argc, argv, ai)) return error("-src-bits requires number of bits (0..8)");
+        ai++;
+      }
+      else
+      if (strcmp(argv[ai], "-all") == 0)   disp = 4 | 2 | 1; // All
+      else
+      if (strcmp(argv[ai], "-msg") == 0)   disp = 4 | 2;     // TCODE and stat.
+      else
+      if (strcmp(argv[ai], "-stat") == 0)  disp = 4;         // Only statistics
+      else
+      if (strcmp(argv[ai], "-none") == 0)  disp = 0;         // Nothing
+      else
+      if (strcmp(argv[ai], "-full") == 0)  disp = 0xFF;      // Everything
+      else
+      {
+        printf("ERROR: Unknown option %s\n", argv[ai]);
+        return 10;
+      }
+    }
+
+    if (conf_Index == NULL) conf_Index = IndexName(argv[2]);
+
+    fNex = fopen(argv[2], "rb");
+    if (fNex == NULL) return error("Cannot open NEX file");
+    if (InfoInit(argv[4]) < 0) return error("Cannot open PCINFO file");
+    for (int k = 0; k < nProc; k++)
+    {
+      if (InfoProcessAdd(procId[k], procInfo[k]) < 0) return error("Cannot open PCINFO file of -process (or process is repeated)");
+    }
+    FILE *fOut = NULL;
+    conf_PcOut = (conf_Profile != NULL || conf_Folded != NULL || conf_Coverage != NULL || conf_Ipc != NULL) ? NULL : argv[6];
+    if (conf_PcOut == NULL) conf_PcBin = 0;
+    if (conf_nSrc == 0 && conf_PcOut != NULL)
+    {
+      fOut = fopen(argv[6], conf_PcBin ? "wb" : "wt");
+      if (fOut == NULL) return error("Cannot create PCOUT file");
+    }
+
+    uint64_t nInstr = 0;
+    int ret = NexusDeco(fOut, disp, &nInstr);
+    if (fOut != NULL) fclose(fOut);
     fclose(fNex); fNex = NULL;
     InfoTerm();
 
-    if (ret > 0)
+    if (ret >= 0)
     {
-      printf("Decoded OK (%d instructions)\n\n", ret);
+      printf("Decoded OK (%lu instructions)\n\n", nInstr);
       ret = 0;
     }
     else
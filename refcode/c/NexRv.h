@@ -59,9 +59,19 @@
 #define NEXUS_FLDSIZE_RCODE     4 // Resource full code size
 
 #define NEXUS_PAR_SIZE_SRC      0 // SRC field size is defined by parameter #0
+#define NEXUS_SRC_BITS_MAX      8 // Max size of SRC field (-src-bits), so max 256 harts
 
 #define NEXUS_HIST_BITS         31 // Number of valid HIST bits
 
+// I-CNT of encoder is unlimited by default. With -icnt it is a counter of
+// given size and ResourceFull (RCODE=0, RDATA=I-CNT) is sent before overflow.
+#define NEXUS_ICNT_BITS_MIN     4  // Min size of I-CNT counter (-icnt)
+#define NEXUS_ICNT_BITS_MAX     32 // Max size of I-CNT counter (encoICNT is 32-bit)
+
+// Timestamps (optional TSTAMP field, last field of each message) are in cycles.
+// Sync messages have absolute time, other messages have time since previous
+// message with TSTAMP (so decoding may start at any sync message).
+
 // Address skipping (on RISC-V LSB of PC is always 0, so it is not encoded)
 #define NEXUS_PARAM_AddrSkip    1
 #define NEXUS_PARAM_AddrUnit    1
@@ -79,6 +89,32 @@ typedef uint64_t Nexus_TypeField;   // This must be same (or bigger than Addr/Hi
 // End of RISC-V related values
 //****************************************************************************
 
+//****************************************************************************
+// Call-stack (implicit return) state. Encoder and decoder (each decoder
+// thread) have own instance. It is reset by each synchronizing message.
+// Return addresses are in a ring allocated by CallStack_Init (depth is set
+// by -cs at run-time), so it must be released by CallStack_Free.
+
+#define CALLSTACK_MAX     4096  // Max depth (-cs)
+#define CALLSTACK_DEFAULT 32    // Depth of decoder (if -cs is not given)
+
+typedef struct NEXRV_CALLSTACK
+{
+  Nexus_TypeAddr  *addr;    // Return addresses (ring of 'max' entries), NULL for counter
+  int             size;     // Number of allocated entries
+  int             top;      // Index of top
+  int             cnt;      // Number of entries (saturating at 'max')
+  int             max;      // Depth (abs(conf))
+  int             conf;     // <0: Just a counter, >0: Stack with addresses
+} NexRvCallStack;
+
+extern int            CallStack_Init(NexRvCallStack *cs, int conf); // Reset (<0 if no memory)
+extern void           CallStack_Push(NexRvCallStack *cs, Nexus_TypeAddr ret);
+extern Nexus_TypeAddr CallStack_Pop(NexRvCallStack *cs);
+extern void           CallStack_Free(NexRvCallStack *cs);
+
+//****************************************************************************
+
 #endif  // NEXRV_H
 
 //****************************************************************************
@@ -0,0 +1,134 @@
+/*
+* Copyright (c) 2020 IAR Systems AB.
+*
+* Permission to use, copy, modify, and distribute this software for any
+* purpose with or without fee is hereby granted, provided that the above
+* copyright notice and this permission notice appear in all copies.
+*
+* THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+* WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+* ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+* WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+* ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+* OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//****************************************************************************
+// File NexRvCallStack.c - Call-stack for implicit return (encoder and decoder)
+
+// Code below is written in plain C-code.
+// It was compiled using VisualC, GNU and IAR C/C++ compiler.
+//  1. Only standard C-types are used.
+//  2. Only few standard C functions used - see notes with "#include <...>"
+//  3. Only non K&R C is 'for (int x' and 'int x;' between instructions.
+
+#include <stdio.h>  //  For 'printf'
+#include <stdlib.h> //  For 'realloc', 'free'
+
+#include "NexRv.h"  //  For NexRvCallStack
+
+// Reset call-stack (ring of addresses is allocated only if it is too small,
+// so it is cheap to call it at each sync message). Structure must be zeroed
+// (or initialized by this function) before first call.
+int CallStack_Init(NexRvCallStack *cs, int conf)
+{
+  cs->conf = conf;
+  cs->cnt = 0;
+  cs->top = 0;
+  if (conf >= 0)
+  {
+    cs->max = conf;
+  }
+  else
+  {
+    cs->max = -conf;
+  }
+
+  if (conf > 0 && cs->size < cs->max)
+  {
+    Nexus_TypeAddr *p = (Nexus_TypeAddr *)realloc(cs->addr, sizeof(Nexus_TypeAddr) * cs->max);
+    if (p == NULL)
+    {
+      cs->conf = 0; // No memory (no call-stack)
+      cs->max  = 0;
+      return -1;
+    }
+    cs->addr = p;
+    cs->size = cs->max;
+  }
+  return 0;
+}
+
+void CallStack_Free(NexRvCallStack *cs)
+{
+  free(cs->addr);
+  cs->addr = NULL;
+  cs->size = 0;
+}
+
+void CallStack_Push(NexRvCallStack *cs, Nexus_TypeAddr ret)
+{
+  if (0) printf("CallPush[%d] 0x%lX\n", cs->cnt + 1, ret);
+
+  if (cs->conf <= 0)
+  {
+    // Callstack without storing addresses (just saturating +- counter)
+    if (cs->cnt < cs->max)
+    {
+      cs->cnt++; // Count (saturating at max)
+    }
+
+    return;
+  }
+
+  // Adjust 'top' (with wrap-around, so oldest entry is overwritten when full)
+  if (cs->top + 1 >= cs->max)
+  {
+    cs->top = 0;  // Wrap-around
+  }
+  else
+  {
+    cs->top++;    // Just next
+  }
+
+  //Store (in new top)
+  cs->addr[cs->top] = ret;
+
+  // Calculate new size (saturating)
+  if (cs->cnt < cs->max)
+  {
+    cs->cnt++;
+  }
+}
+
+Nexus_TypeAddr CallStack_Pop(NexRvCallStack *cs)
+{
+  // Calculate new size (and handle empty)
+  if (cs->cnt == 0) return 1;  // Empty ('1' will never match 'real PC'!
+  cs->cnt--;
+
+  if (cs->conf <= 0)
+  {
+    return 0; // Any non-empty address (it will NOT be compared)
+  }
+
+  if (0) printf("CallPop[%d] 0x%lX\n", cs->cnt + 1, cs->addr[cs->top]);
+
+  int prevTop = cs->top;
+
+  // Adjust 'top' (with wrap-around)
+  if (cs->top == 0)
+  {
+    cs->top = (cs->max - 1);  // Wrap around
+  }
+  else
+  {
+    cs->top--;                // Just previous
+  }
+
+  return cs->addr[prevTop];  // Return element on top (before adjustment)
+}
+
+//****************************************************************************
+// End of NexRvCallStack.c file
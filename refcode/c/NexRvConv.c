@@ -32,6 +32,7 @@
 #include "NexRv.h"  //  Common NEXUS_... #define (RISC-V specific subset)
 
 #include "NexRvInfo.h"  // We need info 
+#include "NexRvPcBin.h" // Binary PCOUT file
 
 // It converts GNU-objdump file (with -d option) to info-file
 
@@ -59,6 +60,53 @@ static Nexus_TypeAddr GetParAddr(const char *l)
   return addr;
 }
 
+// Sequential jump (see -seqjump) is 'jr/jalr' with base register set by
+// 'lui/auipc' just before it, like 'auipc t1,0x12' + 'jalr -84(t1)'.
+// Destination is known from code, so it is in PCINFO ('JS'/'CS' record).
+
+// Get <rd> and value of "lui <rd>,0x<imm>" or "auipc <rd>,0x<imm>" at 'addr'
+static int GetUpperImm(const char *instr, Nexus_TypeAddr addr, char *rd, Nexus_TypeAddr *pVal)
+{
+  int n;
+  if (strncmp(instr, "lui\t", 4) == 0)        n = 4;
+  else if (strncmp(instr, "auipc\t", 6) == 0) n = 6;
+  else return 0;
+
+  uint32_t imm;
+  if (sscanf(instr + n, "%7[^,],%" SCNx32, rd, &imm) != 2) return 0;
+  *pVal = (Nexus_TypeAddr)(int64_t)(int32_t)(imm << 12);  // Sign-extended (as on RV64)
+  if (n == 6) *pVal += addr;
+  return 1;
+}
+
+// Get base register and offset of "jr/jalr [<rd>,][<off>](<rs1>)" or "jr/jalr [<rd>,]<rs1>"
+static int GetJumpBase(const char *instr, char *rs1, int64_t *pOff)
+{
+  while (!(*instr == '\t' || *instr == '\0')) instr++;
+  if (*instr++ != '\t') return 0;  // No parameters (like 'ecall')
+
+  char par[64];
+  size_t len = strcspn(instr, " \t\r\n#<");
+  if (len == 0 || len >= sizeof(par)) return 0;
+  memcpy(par, instr, len);
+  par[len] = '\0';
+
+  char *p = strrchr(par, ',');  // Last parameter
+  p = (p != NULL) ? p + 1 : par;
+  *pOff = 0;
+  char *b = strchr(p, '(');
+  if (b != NULL)
+  {
+    *pOff = strtoll(p, NULL, 10);
+    p = b + 1;
+    if ((b = strchr(p, ')')) == NULL) return 0;
+    *b = '\0';
+  }
+  if (strlen(p) >= 8) return 0;
+  strcpy(rs1, p);
+  return 1;
+}
+
 int ConvRtlTrace(FILE *fIn, FILE *fOut)
 {
   char line[1000];
@@ -78,6 +126,10 @@ int ConvRtlTrace(FILE *fIn, FILE *fOut)
     {
       continue;
     }
+    uint64_t cycle;
+    const char *c = strstr(p, "CycleCount=");
+    int withCycle = (c != NULL && sscanf(c + 11, "%" SCNu64, &cycle) == 1);
+
     p += 3;           // Isolate 64-bit (16-digit) hex number 
     p[16] = '\0';
 
@@ -85,7 +137,9 @@ int ConvRtlTrace(FILE *fIn, FILE *fOut)
       p++;
     if (*p == '\0') p--;
 
-    fprintf(fOut, "0x%s\n", p);
+    fprintf(fOut, "0x%s", p);
+    if (withCycle) fprintf(fOut, " @%lu", cycle);  // Cycle of instruction (see -tstamp)
+    fprintf(fOut, "\n");
     nInstr++;
   }
 
@@ -96,6 +150,10 @@ int ConvGnuObjdump(FILE *fObjd, FILE *fPcInfo)
 {
   char line[1000];
 
+  Nexus_TypeAddr seqEnd = 1;    // End of previous instruction if it is LUI/AUIPC (1 if not)
+  Nexus_TypeAddr seqVal = 0;    // Value of 'seqRd' set by this LUI/AUIPC
+  char seqRd[8] = "";
+
   int nInstr = 0;
   while (fgets(line, sizeof(line), fObjd) != NULL)
   {
@@ -109,6 +167,13 @@ int ConvGnuObjdump(FILE *fObjd, FILE *fPcInfo)
     Nexus_TypeAddr addr;
     if (sscanf(l, "%" SCNx64, &addr) != 1) return -1;
     while (isxdigit(*l)) l++;
+    if (l[0] == ' ' && l[1] == '<')
+    {
+      // Symbol line '<addr> <name>:' - keep it as '.sym' record (for -profile)
+      const char *e = strchr(l + 2, '>');
+      if (e != NULL) fprintf(fPcInfo, ".sym 0x%lX %.*s\n", addr, (int)(e - (l + 2)), l + 2);
+      continue;
+    }
     if (*l++ != ':') continue;
     if (*l++ != '\t') continue;
 
@@ -177,6 +242,20 @@ int ConvGnuObjdump(FILE *fObjd, FILE *fPcInfo)
       if (instr[0] == 'e' && instr[1] == 'c') iType = "CI"; // ECALL=Call indirect
     }
 
+    // Indirect jump/call right after LUI/AUIPC of its base register
+    Nexus_TypeAddr seqDest = 0;
+    char rs1[8];
+    int64_t off;
+    if ((iType[0] == 'J' || iType[0] == 'C') && iType[1] == 'I' && seqEnd == addr &&
+        GetJumpBase(instr, rs1, &off) && strcmp(rs1, seqRd) == 0)
+    {
+      seqDest = (seqVal + (Nexus_TypeAddr)off) & ~(Nexus_TypeAddr)1;
+      if ((addr >> 32) == 0) seqDest &= 0xFFFFFFFF;  // RV32 code (address wraps at 32 bits)
+      iType = (iType[0] == 'J') ? "JS" : "CS";
+    }
+    seqEnd = 1;
+    if (GetUpperImm(instr, addr, seqRd, &seqVal)) seqEnd = addr + size;
+
     // Produce output record
     fprintf(fPcInfo, "0x%lX,%s%d", addr, iType, size);
 
@@ -188,6 +267,7 @@ int ConvGnuObjdump(FILE *fObjd, FILE *fPcInfo)
       if (destAddr & 1) return -(30 + (int)destAddr);
       fprintf(fPcInfo, ",0x%lX", destAddr);
     }
+    if (iType[1] == 'S') fprintf(fPcInfo, ",0x%lX", seqDest);
     fprintf(fPcInfo, "\n");
 
     nInstr++;
@@ -203,6 +283,14 @@ int ConvAddInfo(FILE *fIn, FILE *fOut, FILE *fComp)
 
   Nexus_TypeAddr branchAddr = 0;  // Address of branch instruction
   unsigned int branchSize = 0;  // Size of previous branch
+  char cycle[32] = "";          // ' @<cycle>' of previous instruction (copied to PCSEQ line)
+
+  NexRvPcBin pbComp;            // Used if fComp is binary PCOUT
+  int compBin = 0;
+  if (fComp != NULL)
+  {
+    compBin = PcBin_ReadOpen(&pbComp, fComp);
+  }
 
   int nInstr = 0;
   while (fgets(line, sizeof(line), fIn) != NULL)
@@ -228,6 +316,7 @@ int ConvAddInfo(FILE *fIn, FILE *fOut, FILE *fComp)
       {
         break;
       }
+      continue; // Comment or annotation (like '.process <id>')
     }
 
     Nexus_TypeAddr a;
@@ -244,18 +333,35 @@ int ConvAddInfo(FILE *fIn, FILE *fOut, FILE *fComp)
       nInstr++;
       if (fComp != NULL)
       {
-        if (fgets(line, sizeof(line), fComp) == NULL)
+        Nexus_TypeAddr aa;
+        if (compBin)
         {
-          printf("ERROR: Instruction #%d at address 0x%lX - no PC at PCOUT file.\n", nInstr, a);
-          return -5;
+          int ret = PcBin_Get(&pbComp, &aa);
+          if (ret == 0)
+          {
+            printf("ERROR: Instruction #%d at address 0x%lX - no PC at PCOUT file.\n", nInstr, a);
+            return -5;
+          }
+          if (ret < 0)
+          {
+            printf("ERROR: Binary PCOUT file is corrupted\n");
+            return -6;
+          }
         }
-        const char *l = line;
-
-        Nexus_TypeAddr aa;
-        if (sscanf(l, "%" SCNx64, &aa) != 1)
+        else
         {
-          printf("ERROR: Line %s does not have PC with 0x prefix\n", line);
-          return -6;
+          if (fgets(line, sizeof(line), fComp) == NULL)
+          {
+            printf("ERROR: Instruction #%d at address 0x%lX - no PC at PCOUT file.\n", nInstr, a);
+            return -5;
+          }
+          const char *l = line;
+
+          if (sscanf(l, "%" SCNx64, &aa) != 1)
+          {
+            printf("ERROR: Line %s does not have PC with 0x prefix\n", line);
+            return -6;
+          }
         }
 
         if (a != aa)
@@ -269,7 +375,7 @@ int ConvAddInfo(FILE *fIn, FILE *fOut, FILE *fComp)
     }
 
     InfoAddr aa;
-    unsigned int info = InfoGet(a, &aa);
+    unsigned int info = InfoGet(NULL, a, &aa);
     if (info == 0)
     {
 #if 1 // This is needed for processing of files generated from Spike (there are 5 instructions at the beginning ...)
@@ -287,12 +393,16 @@ int ConvAddInfo(FILE *fIn, FILE *fOut, FILE *fComp)
         // Branch was not taken
         fprintf(fOut, "N");
       }
-      fprintf(fOut, "%d\n", branchSize);
+      fprintf(fOut, "%d%s\n", branchSize, cycle);
       branchSize = 0; // One time deal
     }
 
     nInstr++;
 
+    const char *c = strchr(l, '@');
+    cycle[0] = '\0';
+    if (c != NULL) snprintf(cycle, sizeof(cycle), " @%lu", strtoul(c + 1, NULL, 10));
+
     fprintf(fOut, "0x%lX", a); // Output PC value
     // Append type of instruction to plain PC value
     if (info & INFO_CALL)         fprintf(fOut, ",C");
@@ -303,7 +413,8 @@ int ConvAddInfo(FILE *fIn, FILE *fOut, FILE *fComp)
 
     // Report non-taken branch as BN
 
-    if (info & (INFO_INDIRECT) && !(info & INFO_RET)) fprintf(fOut, "I");
+    if (info & INFO_SEQJUMP) fprintf(fOut, "S");
+    else if (info & (INFO_INDIRECT) && !(info & INFO_RET)) fprintf(fOut, "I");
 
     if (info & INFO_BRANCH)
     {
@@ -314,6 +425,7 @@ int ConvAddInfo(FILE *fIn, FILE *fOut, FILE *fComp)
     }
 
     if (info & INFO_4) fprintf(fOut, "4"); else fprintf(fOut, "2");
+    fprintf(fOut, "%s", cycle);
 
 #if 0 // No need to report direct address
     if (info & (INFO_BRANCH | INFO_JUMP | INFO_CALL))
@@ -331,6 +443,67 @@ int ConvAddInfo(FILE *fIn, FILE *fOut, FILE *fComp)
   return nInstr;
 }
 
+// Convert binary PCOUT (see NexRvPcBin.h) to text PCOUT
+int ConvPcBin(FILE *fIn, FILE *fOut)
+{
+  NexRvPcBin pb;
+  if (PcBin_ReadOpen(&pb, fIn) != 1) return -1;   // Not binary PCOUT
+
+  int nInstr = 0;
+  for (;;)
+  {
+    Nexus_TypeAddr a;
+    int ret = PcBin_Get(&pb, &a);
+    if (ret == 0) break;
+    if (ret < 0) return -2;
+
+    fprintf(fOut, "0x%lX\n", a);
+    nInstr++;
+  }
+
+  return nInstr;
+}
+
+// Convert text PCSEQ to binary PCSEQ (see NexRvPcBin.h). Lines are
+// handled as by encoder ('@<cycle>', '.process <id>', '.e' end-marker).
+int ConvPcsBin(FILE *fIn, FILE *fOut)
+{
+  NexRvPcsBin ps;
+  if (PcsBin_WriteOpen(&ps, fOut) < 0) return -1;
+
+  uint64_t cycle = 0;
+  int nInstr = 0;
+  char line[1000];
+  while (fgets(line, sizeof(line), fIn) != NULL)
+  {
+    if (line[0] == '.' && line[1] == 'e') break; // End
+    if (strncmp(line, ".process ", 9) == 0)
+    {
+      if (PcsBin_Process(&ps, strtoull(line + 9, NULL, 0)) < 0) return -1;
+      continue;
+    }
+    if (line[0] == '.') continue; // Comment (ignore this line)
+    if (line[0] == '\0' || line[0] == '\n' || line[0] == '\r') continue; // Ignore empty as well ...
+
+    InfoAddr a;
+    unsigned int info;
+    if (!InfoParse(line, &a, &info, NULL) || info == 0)
+    {
+      printf("ERROR: Line %s is not PCSEQ line\n", line);
+      return -2;
+    }
+
+    // Cycle of instruction is '@<cycle>' (next cycle if not given)
+    const char *c = strchr(line, '@');
+    if (c == NULL || sscanf(c + 1, "%" SCNu64, &cycle) != 1) cycle++;
+
+    if (PcsBin_Put(&ps, a, info, cycle) < 0) return -1;
+    nInstr++;
+  }
+
+  return nInstr;
+}
+
 static int ConvBin4(FILE *fIn, FILE *fOut)
 {
   // Flip nibbles (in-place) - it may compress buffer as well, what will speed-up processing
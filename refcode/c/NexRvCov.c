@@ -0,0 +1,285 @@
+/*
+* Copyright (c) 2020 IAR Systems AB.
+*
+* Permission to use, copy, modify, and distribute this software for any
+* purpose with or without fee is hereby granted, provided that the above
+* copyright notice and this permission notice appear in all copies.
+*
+* THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+* WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+* ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+* WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+* ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+* OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//****************************************************************************
+// File NexRvCov.c - Coverage bitmaps (instructions and branch directions)
+
+// Code below is written in plain C-code.
+// It was compiled using VisualC, GNU and IAR C/C++ compiler.
+//  1. Only standard C-types are used.
+//  2. Only few standard C functions used - see notes with "#include <...>"
+//  3. Only non K&R C is 'for (int x' and 'int x;' between instructions.
+
+#include <stdio.h>  //  For 'fprintf', 'fwrite', 'fread'
+#include <stdlib.h> //  For 'calloc', 'free'
+#include <string.h> //  For 'memcmp', 'memcpy'
+
+#include "NexRvCov.h"
+#include "NexRvInfo.h"
+
+#define COV_BLOCK 0x1000  // Words written or read (and OR-ed) at once
+
+// FNV-1a hash of address and info of all INFO records (of loaded PCINFO)
+static uint64_t CovInfoHash(void)
+{
+  uint64_t h = 0xCBF29CE484222325UL;
+  int nRec = InfoRecCount();
+  for (int i = 0; i < nRec; i++)
+  {
+    InfoAddr a;
+    uint64_t v = InfoRecGet(i, &a);
+    v ^= a << 8;
+    for (int k = 0; k < 8; k++)
+    {
+      h ^= (v >> (8 * k)) & 0xFF;
+      h *= 0x100000001B3UL;
+    }
+  }
+  return h;
+}
+
+static int CovAlloc(NexRvCov *c, int nRec, uint64_t hash)
+{
+  c->nRec   = nRec;
+  c->nWords = (nRec + 63) / 64;
+  c->hash   = hash;
+  c->bits   = (uint64_t *)calloc((size_t)COV_MAPS * c->nWords + 1, sizeof(uint64_t));
+  return (c->bits == NULL) ? -1 : 0;
+}
+
+// OR 'n' words of 's' to 'd'. Plain loop over whole words (it is vectorized by compiler).
+static void CovOr(uint64_t *d, const uint64_t *s, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    d[i] |= s[i];
+  }
+}
+
+// Empty coverage for INFO records of loaded PCINFO
+int Cov_Init(NexRvCov *c)
+{
+  return CovAlloc(c, InfoRecCount(), CovInfoHash());
+}
+
+void Cov_Set(NexRvCov *c, int map, int rec)
+{
+  if (rec < 0 || rec >= c->nRec) return;
+  c->bits[map * c->nWords + (rec >> 6)] |= ((uint64_t)1) << (rec & 63);
+}
+
+// Set 'n' bits from 'rec' (linear part of basic-block)
+void Cov_SetRange(NexRvCov *c, int map, int rec, uint64_t n)
+{
+  if (rec < 0 || n == 0) return;
+  uint64_t end = rec + n;
+  if (end > (uint64_t)c->nRec) end = c->nRec;
+  uint64_t *w = &c->bits[map * c->nWords];
+  for (uint64_t i = rec; i < end; )
+  {
+    uint64_t k = 64 - (i & 63);   // Bits till end of this word
+    if (k > end - i) k = end - i;
+    w[i >> 6] |= ((k == 64) ? ~(uint64_t)0 : ((((uint64_t)1) << k) - 1)) << (i & 63);
+    i += k;
+  }
+}
+
+// Add (OR) coverage 'src' to 'dst' (both must be for the same PCINFO)
+int Cov_Merge(NexRvCov *dst, const NexRvCov *src)
+{
+  if (dst->nRec != src->nRec || dst->hash != src->hash) return -1;
+  CovOr(dst->bits, src->bits, (size_t)COV_MAPS * dst->nWords);
+  return 0;
+}
+
+// File is little-endian (on any host), so bytes are stored one by one
+static void CovPutLE(unsigned char *p, uint64_t v, int nBytes)
+{
+  for (int i = 0; i < nBytes; i++)
+  {
+    p[i] = (unsigned char)(v >> (8 * i));
+  }
+}
+
+static uint64_t CovGetLE(const unsigned char *p, int nBytes)
+{
+  uint64_t v = 0;
+  for (int i = 0; i < nBytes; i++)
+  {
+    v |= ((uint64_t)p[i]) << (8 * i);
+  }
+  return v;
+}
+
+int Cov_Write(const NexRvCov *c, FILE *f)
+{
+  unsigned char hdr[24];
+  memcpy(hdr, NEXRV_COV_MAGIC, 8);
+  CovPutLE(hdr + 8, (uint32_t)c->nRec, 4);
+  CovPutLE(hdr + 12, COV_MAPS, 4);
+  CovPutLE(hdr + 16, c->hash, 8);
+  if (fwrite(hdr, 1, sizeof(hdr), f) != sizeof(hdr)) return -1;
+
+  unsigned char buf[8 * COV_BLOCK];
+  size_t n = (size_t)COV_MAPS * c->nWords;
+  for (size_t i = 0; i < n; )
+  {
+    size_t k = (n - i < COV_BLOCK) ? n - i : COV_BLOCK;
+    for (size_t j = 0; j < k; j++)
+    {
+      CovPutLE(buf + 8 * j, c->bits[i + j], 8);
+    }
+    if (fwrite(buf, 8, k, f) != k) return -1;
+    i += k;
+  }
+  return 0;
+}
+
+// Read coverage file and add (OR) it to 'c'. Empty 'c' (bits==NULL) is
+// created by the first file, next files must be for the same PCINFO.
+// Returns -1 (bad file), -2 (different PCINFO) or -3 (no memory).
+int Cov_Read(NexRvCov *c, FILE *f)
+{
+  unsigned char hdr[24];
+  if (fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || memcmp(hdr, NEXRV_COV_MAGIC, 8) != 0) return -1;
+  int nRec      = (int)CovGetLE(hdr + 8, 4);
+  uint64_t hash = CovGetLE(hdr + 16, 8);
+  if (CovGetLE(hdr + 12, 4) != COV_MAPS) return -1;
+
+  if (c->bits == NULL)
+  {
+    if (CovAlloc(c, nRec, hash) < 0) return -3;
+  }
+  else
+  if (nRec != c->nRec || hash != c->hash) return -2;
+
+  unsigned char buf[8 * COV_BLOCK];
+  uint64_t w[COV_BLOCK];
+  size_t n = (size_t)COV_MAPS * c->nWords;
+  for (size_t i = 0; i < n; )
+  {
+    size_t k = (n - i < COV_BLOCK) ? n - i : COV_BLOCK;
+    if (fread(buf, 8, k, f) != k) return -1;
+    for (size_t j = 0; j < k; j++)
+    {
+      w[j] = CovGetLE(buf + 8 * j, 8);
+    }
+    CovOr(&c->bits[i], w, k);
+    i += k;
+  }
+  return 0;
+}
+
+#if 1 // Coverage report (-cov-report)
+
+typedef struct COV_FUNC
+{
+  int nInstr;       // Instructions of function
+  int nExec;        // ... executed
+  int nBranch;      // Branches of function (each has 2 directions)
+  int nDir;         // ... executed directions
+} COV_FUNC;
+
+// Write coverage report of functions (symbols of loaded PCINFO and process
+// images, which must be the same as of coverage) and list of partially
+// covered branches.
+// With 'f' NULL, only summary is displayed.
+int Cov_Report(const NexRvCov *c, FILE *f, int disp)
+{
+  if (c->nRec != InfoRecCount() || c->hash != CovInfoHash()) return -2;
+
+  int nSym = InfoSymCount();
+  COV_FUNC *fn = (COV_FUNC *)calloc(nSym + 1, sizeof(COV_FUNC));  // Last one is for code without symbol
+  if (fn == NULL) return -3;
+
+  COV_FUNC all;
+  memset(&all, 0, sizeof(all));
+  int nPartial = 0;
+  for (int i = 0; i < c->nRec; i++)
+  {
+    InfoAddr a;
+    unsigned int info = InfoRecGet(i, &a);
+    int sym = InfoSymFind(InfoRecImage(i), a);
+    COV_FUNC *p = &fn[(sym >= 0) ? sym : nSym];
+    int exec = (int)COV_GET(c, COV_EXEC, i);
+    p->nInstr++;
+    p->nExec += exec;
+    if (info & INFO_BRANCH)
+    {
+      int t = (int)COV_GET(c, COV_TAKEN, i);
+      int nt = (int)COV_GET(c, COV_NTAKEN, i);
+      p->nBranch++;
+      p->nDir += t + nt;
+      if (exec && t + nt < 2) nPartial++;
+    }
+  }
+  for (int k = 0; k <= nSym; k++)
+  {
+    all.nInstr  += fn[k].nInstr;
+    all.nExec   += fn[k].nExec;
+    all.nBranch += fn[k].nBranch;
+    all.nDir    += fn[k].nDir;
+  }
+
+  if (f != NULL)
+  {
+    fprintf(f, ". NexRv coverage: %d of %d instructions (%.2lf%%), %d of %d branch directions (%.2lf%%)\n",
+      all.nExec, all.nInstr, (all.nInstr > 0) ? (100.0 * all.nExec) / all.nInstr : 0.0,
+      all.nDir, 2 * all.nBranch, (all.nBranch > 0) ? (50.0 * all.nDir) / all.nBranch : 0.0);
+    fprintf(f, ". Functions: <executed>,<instr>,<percent>,<directions>,<branches*2>,<percent>,<addr>,<name>\n");
+    for (int k = 0; k <= nSym; k++)
+    {
+      if (fn[k].nInstr == 0) continue;
+      InfoAddr sa = 0;
+      const char *name = (k < nSym) ? InfoSymGet(k, &sa) : "?";
+      fprintf(f, "%d,%d,%.2lf,%d,%d,%.2lf,0x%lX,%s\n", fn[k].nExec, fn[k].nInstr, (100.0 * fn[k].nExec) / fn[k].nInstr,
+        fn[k].nDir, 2 * fn[k].nBranch, (fn[k].nBranch > 0) ? (50.0 * fn[k].nDir) / fn[k].nBranch : 100.0, sa, name);
+    }
+
+    // Executed branches with one direction only
+    fprintf(f, ". Partial branches: <addr>,<taken>,<not-taken>,<function>\n");
+    for (int i = 0; i < c->nRec; i++)
+    {
+      InfoAddr a;
+      if (!(InfoRecGet(i, &a) & INFO_BRANCH) || !COV_GET(c, COV_EXEC, i)) continue;
+      int t = (int)COV_GET(c, COV_TAKEN, i);
+      int nt = (int)COV_GET(c, COV_NTAKEN, i);
+      if (t + nt == 2) continue;
+      int sym = InfoSymFind(InfoRecImage(i), a);
+      fprintf(f, "0x%lX,%d,%d,%s\n", a, t, nt, (sym >= 0) ? InfoSymGet(sym, NULL) : "?");
+    }
+  }
+
+  if (disp & 4)
+  {
+    printf("NexRv/Coverage: %d of %d instructions, %d of %d branch directions, %d partial branches\n",
+      all.nExec, all.nInstr, all.nDir, 2 * all.nBranch, nPartial);
+  }
+
+  free(fn);
+  return 0;
+}
+
+#endif
+
+void Cov_Free(NexRvCov *c)
+{
+  free(c->bits);
+  c->bits = NULL;
+}
+
+//****************************************************************************
+// End of NexRvCov.c file
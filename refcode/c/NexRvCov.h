@@ -0,0 +1,65 @@
+/*
+* Copyright (c) 2020 IAR Systems AB.
+*
+* Permission to use, copy, modify, and distribute this software for any
+* purpose with or without fee is hereby granted, provided that the above
+* copyright notice and this permission notice appear in all copies.
+*
+* THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+* WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+* ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+* WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+* ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+* OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//****************************************************************************
+// File NexRvCov.h  - Coverage bitmaps (instructions and branch directions)
+
+// Coverage is 3 bitmaps with one bit for each INFO record (instruction) of
+// PCINFO file - executed instruction, taken branch and not taken branch.
+// Coverage file is 24-byte header followed by all bitmaps:
+//   NEXRV_COV_MAGIC, <nRec> (32-bit), <nMaps> (32-bit), <hash> (64-bit)
+//   <nMaps> * <nWords> 64-bit words (little-endian)
+// Hash of PCINFO records is kept, so only coverage of the same program is
+// merged (files of many runs are OR-ed by whole words).
+
+#ifndef NEXRVCOV_H
+#define NEXRVCOV_H
+
+#include <stdio.h>  // For FILE
+#include <stdint.h> // For uint64_t
+
+#define NEXRV_COV_MAGIC "NXRVCOV1"  // 8 bytes (without '\0')
+
+#define COV_EXEC    0   // Executed instruction
+#define COV_TAKEN   1   // Taken branch (INFO_BRANCH records only)
+#define COV_NTAKEN  2   // Not taken branch
+#define COV_MAPS    3   // Number of bitmaps
+
+typedef struct NEXRV_COV
+{
+  int       nRec;       // Number of INFO records (bits of each bitmap)
+  int       nWords;     // Number of 64-bit words of each bitmap
+  uint64_t  hash;       // Hash of INFO records (address and info of each)
+  uint64_t  *bits;      // All bitmaps (COV_MAPS * nWords words), or NULL
+} NexRvCov;
+
+extern int  Cov_Init(NexRvCov *c);
+extern void Cov_Set(NexRvCov *c, int map, int rec);
+extern void Cov_SetRange(NexRvCov *c, int map, int rec, uint64_t n);
+extern int  Cov_Merge(NexRvCov *dst, const NexRvCov *src);
+extern int  Cov_Write(const NexRvCov *c, FILE *f);
+extern int  Cov_Read(NexRvCov *c, FILE *f);
+extern int  Cov_Report(const NexRvCov *c, FILE *f, int disp);
+extern void Cov_Free(NexRvCov *c);
+
+// Value of bit 'rec' of bitmap 'map'
+#define COV_GET(c, map, rec) \
+  (((c)->bits[(map) * (c)->nWords + ((rec) >> 6)] >> ((rec) & 63)) & 1)
+
+#endif  // NEXRVCOV_H
+
+//****************************************************************************
+// End of NexRvCov.h file
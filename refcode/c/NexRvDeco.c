@@ -31,26 +31,147 @@
 #include "NexRv.h"    //  Common NEXUS_... #define (RISC-V specific subset)
 #include "NexRvMsg.h" //  Definition of Nexus messages
 #include "NexRvInfo.h" //  Definition of Nexus messages
+#include "NexRvFile.h" //  Reading of Nexus file (NEXRV_FILE_GET)
+#include "NexRvScan.h" //  Skipping of idles (NexRvScan_Idle)
+#include "NexRvPcBin.h" // Binary PCOUT file
+#include "NexRvCov.h"   // Coverage bitmaps (-coverage)
+#include "NexRvDeco.h"  // Decoder library API (NexRvDeco_...)
+
+#ifndef NEXRV_LIB
+#define NEXRV_LIB 0       // 1: Only library API is built (no files, no conf_... options)
+#endif
+
+#ifndef NEXRV_THREADS
+#if defined(__unix__) || defined(__APPLE__)
+#define NEXRV_THREADS 1   // Segments are decoded by POSIX threads (-j option)
+#else
+#define NEXRV_THREADS 0   // Segments are decoded one after another
+#endif
+#endif
 
+#if NEXRV_THREADS
+#include <pthread.h>  //  For 'pthread_create', 'pthread_join'
+#endif
+
+#if !NEXRV_LIB
 // Decoder works on two files and dumper on first file
 extern FILE *fNex;      // Nexus messages (binary bytes)
 
 extern int conf_nSrc;   // Number of source bits
+extern int conf_PcBin;  // Binary PCOUT file (instead of text)
+extern int conf_Jobs;   // Number of decoder threads
+extern const char *conf_Index;  // Index file (see -index)
+extern uint64_t conf_From;      // Decode from this instruction (-from) ...
+extern uint64_t conf_Offset;    // ... or from sync before this file offset (-offset)
+extern uint64_t conf_Count;     // Number of instructions to decode (0=all)
+extern int conf_nSrc;           // Size of SRC field (multi-hart trace)
+extern const char *conf_PcOut;  // PCOUT file name (per-hart files are derived from it)
+extern int conf_Resync;         // Continue after errors (from next sync message)
+extern int conf_SeqJump;        // Sequential jumps are not reported (-seqjump)
+extern int conf_MsbExt;         // MSB of address fields is extended (-msbext)
+extern const char *conf_Profile; // Profile file (-profile), no PCOUT then
+extern const char *conf_Folded;  // Folded-stack file (-folded), no PCOUT then
+extern const char *conf_Coverage; // Coverage file (-coverage), no PCOUT then
+extern const char *conf_Ipc;    // IPC report (-ipc), no PCOUT then
+extern uint64_t conf_Window;    // Time window of IPC report (cycles)
 
 #if 1 // Callstack related
 extern int conf_CallStack;
-extern void CallStack_Init();
-extern void CallStack_Push(Nexus_TypeAddr ret);
-extern Nexus_TypeAddr CallStack_Pop();
 #endif
+#endif  // !NEXRV_LIB
 
-int dispHistRepeat = 0;
-
-static Nexus_TypeAddr nexdeco_pc        = 1;  // 1 means, that last address is unknown 
-static Nexus_TypeAddr nexdeco_addrCheck = 1;  // Next PC (sent in a packet should match it)
-static Nexus_TypeAddr nexdeco_lastAddr  = 1;
-static int nInstr = 0;
-static int resourceFull_ICNT = 0; // ICNT adjustment because of recent 'ResourceFull' message[s] (positive or negative)
+// Decoder state. All of it is here (not in static variables), so trace
+// segments (starting with sync message) can be decoded in parallel.
+struct NEXRV_DECO
+{
+  Nexus_TypeAddr  pc;                 // 1 means, that last address is unknown 
+  Nexus_TypeAddr  addrCheck;          // Next PC (sent in a packet should match it)
+  Nexus_TypeAddr  lastAddr;
+  uint64_t        nInstr;             // Number of instructions (index of next one)
+  int             resourceFull_ICNT;  // ICNT adjustment because of recent 'ResourceFull' message[s] (positive or negative)
+  int             dispHistRepeat;
+  Nexus_TypeField msgFields[NEXF_MAX];    // Fields of current message (by NEXF_... slot)
+  Nexus_TypeField savedFields[NEXF_MAX];  // Fields of message before RepeatBranch
+  NexRvCallStack  callStack;
+  FILE            *f;                 // Text PCOUT file (or NULL)
+  NexRvPcBin      *pcBin;             // Binary PCOUT writer (or NULL)
+  uint64_t        endPos;             // Stop after message starting at this offset (or later)
+  uint64_t        outFrom;            // Output instructions from this one (-from) ...
+  uint64_t        outTo;              // ... till this one (-count). Stop after that.
+  FILE            *fIdx;              // Index file (-index), or NULL
+  int             srcBits;            // Size of SRC field (-src-bits)
+  int             statFast;           // -stat-fast: 1=only count fields, 2=count and walk blocks (no PCOUT)
+  int             seqJump;            // Sequential jumps were not reported by encoder (-seqjump)
+  int             msbExt;             // MSB of last MDO of U-ADDR/F-ADDR is extended (-msbext)
+
+  // Parser state (message may be split in many NexRvDeco_Feed calls)
+  int             fldDef;             // Index of current field in 'nexusMsgDef' (-1 between messages)
+  int             fldBits;
+  Nexus_TypeField fldVal;
+  unsigned char   prevByte;
+  uint64_t        bytePos;            // Offset of next byte (in file or stream)
+  uint64_t        msgPos;             // Offset of current message
+  int             lastMsg;            // Handling message at 'endPos' (last one)
+  int             lastCnt;            // Statistics before last message
+  int             lastBytes;
+  uint64_t        lastHW;
+
+  // Statistics
+  int             msgCnt;
+  int             msgBytes;
+  int             msgErrors;
+  uint64_t        nHW;                // Sum of ICNT fields (16-bit units)
+  uint64_t        nBranch;            // Number of HIST bits (direct branches)
+  int             tcodeCnt[1 << NEXUS_FLDSIZE_TCODE]; // Messages by TCODE
+
+  NexRvDeco_InstrFn instrFn;          // Callback for each instruction (library API), or NULL
+  void            *user;              // Parameter of 'instrFn'
+
+  struct DECO_HCACHE *hc;             // Cache of HIST walks (allocated on first use), or NULL
+
+  // Recovery from errors (-resync)
+  int             resync;             // 1=continue after error (from next sync message)
+  int             skipMsg;            // Skipping rest of broken message (till MSEO='11')
+  int             waitSync;           // Skipping messages till next sync message
+  uint64_t        errPos;             // Offset of first lost byte (of current gap)
+  int             nGaps;              // Number of recovered errors
+  uint64_t        lostBytes;          // Sum of bytes of all gaps
+  uint64_t        lostHW;             // Sum of ICNT units of skipped messages
+
+  int64_t         *prof;              // Execution counts (-profile) by INFO record (as differences), or NULL
+  struct DECO_FOLD *fold;             // Call-tree (-folded), or NULL
+  NexRvCov        *cov;               // Coverage bitmaps (-coverage), or NULL
+  struct DECO_IPC *ipc;               // Cycles and instructions by time and function (-ipc), or NULL
+
+  // Time (TSTAMP fields: absolute in sync messages, relative in others)
+  int             msgTstamp;          // Current message has TSTAMP field
+  int             timeValid;          // 'time' is known (since sync message with TSTAMP)
+  uint64_t        time;               // Time (cycles) of last message with TSTAMP
+  uint64_t        timeFirst;          // Time of first sync message with TSTAMP
+  uint64_t        nTstamp;            // Number of messages with TSTAMP (and known time)
+
+  uint64_t        process;            // PROCESS of last Ownership message (selects code image)
+  int             processValid;       // Ownership message was seen ('process' is known)
+  const InfoImage *img;               // Code image of 'process' (NULL is image of InfoInit)
+};
+
+static void DecoInit(NexRvDeco *d, FILE *f, NexRvPcBin *pcBin, int callStack)
+{
+  memset(d, 0, sizeof(*d));
+  d->pc         = 1;
+  d->addrCheck  = 1;
+  d->lastAddr   = 1;
+  d->f          = f;
+  d->pcBin      = pcBin;
+  d->endPos     = ~(uint64_t)0; // Till end of file
+  d->outTo      = ~(uint64_t)0;
+  d->fldDef     = -1;
+#if !NEXRV_LIB
+  d->seqJump    = conf_SeqJump;
+  d->msbExt     = conf_MsbExt;
+#endif
+  CallStack_Init(&d->callStack, callStack);
+}
 
 static int EmitErrorMsg(const char *err)
 {
@@ -58,19 +179,538 @@ static int EmitErrorMsg(const char *err)
   return -10;
 }
 
+#if 1 // Cache of HIST walks (ResourceFull messages)
+
+// Loops produce many ResourceFull messages with same HIST (or RCODE=2 with
+// HREPEAT), which all walk the same path from the same PC. Result of a walk
+// (exit PC, ICNT units, instructions, call-stack pushes and PCs if PCOUT is
+// written) is cached by (start PC, HIST). Walks, which pop the call-stack
+// are not cached.
+
+#define DECO_HCACHE_SIZE  4096        // Number of entries (power of 2)
+#define DECO_HCACHE_PCS   (1 << 20)   // Max number of PCs of all cached walks
+#define DECO_HWALK_PUSH   4           // Max number of call-stack pushes in a walk
+
+typedef struct DECO_HWALK
+{
+  Nexus_TypeAddr  pc;         // Start PC (1 if entry is empty)
+  Nexus_TypeHist  hist;       // HIST
+  Nexus_TypeAddr  exitPc;     // PC after the walk
+  int             nHW;        // ICNT units of the walk (EmitICNT return value)
+  int             nInstr;     // Number of instructions (PCs from 'slice')
+  int             slice;      // Index of first PC in 'pcs' (-1 if PCs are not recorded)
+  int             nPush;
+  Nexus_TypeAddr  push[DECO_HWALK_PUSH];  // Return addresses pushed by calls
+} DECO_HWALK;
+
+typedef struct DECO_HCACHE
+{
+  DECO_HWALK      e[DECO_HCACHE_SIZE];
+  Nexus_TypeAddr  *pcs;       // PCs of all cached walks
+  unsigned int    *infos;     // Info of these PCs (for NexRvDeco_InstrFn)
+  int             nPcs;
+  int             capPcs;
+  int             full;       // 'pcs' is full (cache is flushed on next miss)
+  int             rec;        // Walk is recorded (see EmitICNT)
+  int             recPcs;     // PCs of walk are recorded too (PC output is requested)
+  int             bad;        // Recorded walk cannot be cached
+  DECO_HWALK      cur;        // Walk being recorded
+  uint64_t        hits;
+  uint64_t        misses;
+} DECO_HCACHE;
+
+static void DecoRecInstr(DECO_HCACHE *hc, Nexus_TypeAddr pc, unsigned int info)
+{
+  if (hc->nPcs >= hc->capPcs)
+  {
+    int cap = (hc->capPcs == 0) ? 0x1000 : 2 * hc->capPcs;
+    Nexus_TypeAddr *pcs = NULL;
+    unsigned int *infos = NULL;
+    if (cap <= DECO_HCACHE_PCS)
+    {
+      pcs   = (Nexus_TypeAddr *)realloc(hc->pcs, cap * sizeof(Nexus_TypeAddr));
+      if (pcs != NULL) hc->pcs = pcs;
+      infos = (unsigned int *)realloc(hc->infos, cap * sizeof(unsigned int));
+      if (infos != NULL) hc->infos = infos;
+    }
+    if (pcs == NULL || infos == NULL)
+    {
+      hc->full = 1;
+      hc->bad  = 1;
+      return;
+    }
+    hc->capPcs = cap;
+  }
+  hc->pcs[hc->nPcs]   = pc;
+  hc->infos[hc->nPcs] = info;
+  hc->nPcs++;
+}
+
+// Code image was changed (Ownership message), so no cached walk is valid
+static void DecoHistFlush(DECO_HCACHE *hc)
+{
+  for (int k = 0; k < DECO_HCACHE_SIZE; k++) hc->e[k].pc = 1;
+  hc->nPcs = 0;
+  hc->full = 0;
+}
+
+static void DecoRecPush(DECO_HCACHE *hc, Nexus_TypeAddr ret)
+{
+  if (hc->cur.nPush >= DECO_HWALK_PUSH)
+  {
+    hc->bad = 1;
+    return;
+  }
+  hc->cur.push[hc->cur.nPush++] = ret;
+}
+
+#endif
+
+#if 1 // Execution counts (-profile)
+
+// Count of each instruction (INFO record) is kept as difference to count of
+// previous record, so linear part of a block is counted in O(1) - by +1 at
+// its first record and -1 after its last record. Counts are summed when the
+// profile is written (see DecoProfWrite).
+
+static int DecoProfInit(NexRvDeco *d)
+{
+  d->prof = (int64_t *)calloc(InfoRecCount() + 1, sizeof(int64_t));
+  return (d->prof == NULL) ? -1 : 0;
+}
+
+// Part of 'k' instructions (from #'d->nInstr') in -from/-count window.
+// Returns number of them (first one is '*pLo').
+static uint64_t DecoOutRange(const NexRvDeco *d, uint64_t k, uint64_t *pLo)
+{
+  uint64_t lo = 0;
+  uint64_t hi = k;
+  if (d->outFrom > d->nInstr) lo = d->outFrom - d->nInstr;
+  if (d->outTo < d->nInstr + hi) hi = (d->outTo > d->nInstr) ? d->outTo - d->nInstr : 0;
+  *pLo = lo;
+  return (lo < hi) ? hi - lo : 0;
+}
+
+// Count 'k' records from 'rec' (first one is instruction #'d->nInstr'), only in -from/-count window
+static void DecoProfRange(NexRvDeco *d, int rec, unsigned int k)
+{
+  uint64_t lo;
+  uint64_t n = DecoOutRange(d, k, &lo);
+  if (n == 0) return;
+  d->prof[rec + lo]++;
+  d->prof[rec + lo + n]--;
+}
+
+// Count one instruction at 'pc' (caller checks -from/-count window)
+static void DecoProfPc(NexRvDeco *d, Nexus_TypeAddr pc)
+{
+  int rec = InfoRecFind(d->img, pc);
+  if (rec < 0) return;
+  d->prof[rec]++;
+  d->prof[rec + 1]--;
+}
+
+#endif
+
+#if 1 // Coverage bitmaps (-coverage)
+
+static int DecoCovInit(NexRvDeco *d)
+{
+  d->cov = (NexRvCov *)calloc(1, sizeof(NexRvCov));
+  if (d->cov == NULL) return -1;
+  return Cov_Init(d->cov);
+}
+
+// Mark 'k' records from 'rec' as executed (first one is instruction #'d->nInstr'), only in -from/-count window
+static void DecoCovRange(NexRvDeco *d, int rec, unsigned int k)
+{
+  uint64_t lo;
+  uint64_t n = DecoOutRange(d, k, &lo);
+  Cov_SetRange(d->cov, COV_EXEC, rec + (int)lo, n);
+}
+
+#endif
+
+#if 1 // Call-tree of functions (-folded)
+
+// Shadow call-stack of functions (entered by CALL and left by RET) is a path
+// in call-tree. Executed instructions are added to node of current path, so
+// each node is one line of folded-stack output ("main;foo;bar <instr>").
+// Function is found by PC of its first executed instruction (see DecoFoldAdd).
+
+#define DECO_FOLD_DEPTH 256   // Max depth of call-tree (deeper calls are not followed)
+
+typedef struct DECO_FNODE
+{
+  int       sym;      // Function (symbol index, -1 if not known)
+  int       parent;   // Parent node (-1 for root)
+  int       child;    // First child (or -1)
+  int       next;     // Next sibling (or -1)
+  int       depth;    // 0 for root
+  uint64_t  instr;    // Instructions executed in this function (on this path)
+} DECO_FNODE;
+
+typedef struct DECO_FOLD
+{
+  DECO_FNODE  *n;     // All nodes (0 is root)
+  int         nNodes;
+  int         cap;
+  int         cur;    // Node of current function
+  int         enter;  // Function is entered (node is found by next instruction)
+  int         over;   // Calls deeper than DECO_FOLD_DEPTH (not followed)
+} DECO_FOLD;
+
+// Child of 'parent' node for function 'sym' (it is created if not found)
+static int DecoFoldChild(DECO_FOLD *fo, int parent, int sym)
+{
+  for (int k = fo->n[parent].child; k >= 0; k = fo->n[k].next)
+  {
+    if (fo->n[k].sym == sym) return k;
+  }
+  if (fo->nNodes >= fo->cap)
+  {
+    DECO_FNODE *n = (DECO_FNODE *)realloc(fo->n, 2 * fo->cap * sizeof(DECO_FNODE));
+    if (n == NULL) return parent;   // Instructions are added to caller then
+    fo->n   = n;
+    fo->cap = 2 * fo->cap;
+  }
+  DECO_FNODE *e = &fo->n[fo->nNodes];
+  e->sym    = sym;
+  e->parent = parent;
+  e->child  = -1;
+  e->next   = fo->n[parent].child;
+  e->depth  = fo->n[parent].depth + 1;
+  e->instr  = 0;
+  fo->n[parent].child = fo->nNodes;
+  return fo->nNodes++;
+}
+
+static int DecoFoldInit(NexRvDeco *d)
+{
+  DECO_FOLD *fo = (DECO_FOLD *)calloc(1, sizeof(DECO_FOLD));
+  if (fo == NULL) return -1;
+  fo->cap = 256;
+  fo->n   = (DECO_FNODE *)malloc(fo->cap * sizeof(DECO_FNODE));
+  if (fo->n == NULL)
+  {
+    free(fo);
+    return -1;
+  }
+  fo->n[0].sym    = -1;
+  fo->n[0].parent = -1;
+  fo->n[0].child  = -1;
+  fo->n[0].next   = -1;
+  fo->n[0].depth  = 0;
+  fo->n[0].instr  = 0;
+  fo->nNodes      = 1;
+  fo->enter       = 1;
+  d->fold = fo;
+  return 0;
+}
+
+// Stack is not known (start of trace, lost PC)
+static void DecoFoldReset(DECO_FOLD *fo)
+{
+  fo->cur   = 0;
+  fo->enter = 1;
+  fo->over  = 0;
+}
+
+// Add 'k' instructions (first one at 'pc') to current function
+static void DecoFoldAdd(DECO_FOLD *fo, const InfoImage *img, Nexus_TypeAddr pc, uint64_t k)
+{
+  if (fo->enter)
+  {
+    fo->cur   = DecoFoldChild(fo, fo->cur, InfoSymFind(img, pc));
+    fo->enter = 0;
+  }
+  fo->n[fo->cur].instr += k;
+}
+
+// Terminator of block (after DecoFoldAdd for it)
+static void DecoFoldTerm(DECO_FOLD *fo, unsigned int info)
+{
+  if (info & INFO_CALL)
+  {
+    if (fo->n[fo->cur].depth >= DECO_FOLD_DEPTH) fo->over++;
+    else                                         fo->enter = 1;
+  }
+  else
+  if (info & INFO_RET)
+  {
+    if (fo->over > 0) fo->over--;
+    else
+    if (fo->n[fo->cur].depth > 1) fo->cur = fo->n[fo->cur].parent;
+    else
+    {
+      // Return from first level - caller is not known (it is first level then)
+      fo->cur   = 0;
+      fo->enter = 1;
+    }
+  }
+}
+
+// Add call-tree 'src' (from node 'sn') to 'dst' (to node 'dn')
+static void DecoFoldMerge(DECO_FOLD *dst, int dn, const DECO_FOLD *src, int sn)
+{
+  dst->n[dn].instr += src->n[sn].instr;
+  for (int k = src->n[sn].child; k >= 0; k = src->n[k].next)
+  {
+    DecoFoldMerge(dst, DecoFoldChild(dst, dn, src->n[k].sym), src, k);
+  }
+}
+
+#endif
+
+#if 1 // Time-resolved IPC (-ipc)
+
+// Cycles between two messages with TSTAMP are given to instructions decoded
+// between them (evenly). Instructions are counted by function (found by PC
+// of first instruction of block) only since previous TSTAMP, so memory does
+// not depend on size of trace. Time windows are written when complete.
+
+typedef struct DECO_IPC
+{
+  FILE        *f;         // Report file (windows are written while decoding)
+  uint64_t    window;     // Size of time window (cycles)
+  int         nFn;        // Number of functions (last one is for code without symbol)
+  int         fn;         // Function of last instruction (stall cycles are given to it)
+  InfoAddr    fnLo;       // Address range of 'fn' (no search while PC is in it)
+  InfoAddr    fnHi;
+  uint64_t    *pend;      // Instructions of each function since previous TSTAMP
+  int         *pendFn;    // Functions with 'pend' > 0
+  int         nPend;
+  uint64_t    pendInstr;  // Sum of 'pend'
+  double      *fnCycles;  // Cycles of each function (whole trace)
+  uint64_t    *fnInstr;   // Instructions of each function (whole trace)
+  double      *winFn;     // Instructions of each function in current window
+  int         *winList;   // Functions with 'winFn' > 0
+  int         nWinList;
+  double      winInstr;   // Instructions in current window
+  uint64_t    winCycles;  // Cycles in current window (with known time)
+  uint64_t    winStart;   // Time of start of current window
+  int         nWin;       // Number of written windows
+  int         timeValid;  // 'time' is known
+  uint64_t    time;       // Time of previous TSTAMP
+  uint64_t    cycles;     // Sum of cycles with known time
+  uint64_t    instr;      // Sum of instructions with known time
+  uint64_t    noTime;     // Instructions decoded while time was not known
+} DECO_IPC;
+
+static int DecoIpcInit(NexRvDeco *d, FILE *f, uint64_t window)
+{
+  DECO_IPC *ip = (DECO_IPC *)calloc(1, sizeof(DECO_IPC));
+  if (ip == NULL) return -1;
+  ip->f        = f;
+  ip->window   = window;
+  ip->nFn      = InfoSymCount() + 1;
+  ip->fn       = ip->nFn - 1;
+  ip->pend     = (uint64_t *)calloc(ip->nFn, sizeof(uint64_t));
+  ip->pendFn   = (int *)malloc(ip->nFn * sizeof(int));
+  ip->fnCycles = (double *)calloc(ip->nFn, sizeof(double));
+  ip->fnInstr  = (uint64_t *)calloc(ip->nFn, sizeof(uint64_t));
+  ip->winFn    = (double *)calloc(ip->nFn, sizeof(double));
+  ip->winList  = (int *)malloc(ip->nFn * sizeof(int));
+  d->ipc = ip;
+  if (ip->pend == NULL || ip->pendFn == NULL || ip->fnCycles == NULL || ip->fnInstr == NULL || ip->winFn == NULL || ip->winList == NULL) return -1;
+  fprintf(f, ". Windows: <start>,<cycles>,<instr>,<IPC>,<function>,<percent>\n");
+  return 0;
+}
+
+static void DecoIpcFree(DECO_IPC *ip)
+{
+  free(ip->pend);
+  free(ip->pendFn);
+  free(ip->fnCycles);
+  free(ip->fnInstr);
+  free(ip->winFn);
+  free(ip->winList);
+  free(ip);
+}
+
+// Add 'k' instructions (first one at 'pc') to function of 'pc'
+static void DecoIpcAdd(DECO_IPC *ip, const InfoImage *img, Nexus_TypeAddr pc, uint64_t k)
+{
+  if (k == 0) return;
+  if (pc < ip->fnLo || pc >= ip->fnHi)
+  {
+    int sym = InfoSymFind(img, pc);
+    ip->fn   = (sym >= 0) ? sym : ip->nFn - 1;
+    ip->fnLo = 0;
+    ip->fnHi = 0;   // Not in function (search again)
+    if (sym >= 0)
+    {
+      // Function extends till next symbol of the same image
+      InfoSymGet(sym, &ip->fnLo);
+      ip->fnHi = ~(InfoAddr)0;
+      if (sym + 1 < ip->nFn - 1 && InfoSymImage(sym + 1) == img) InfoSymGet(sym + 1, &ip->fnHi);
+    }
+  }
+  if (ip->pend[ip->fn] == 0) ip->pendFn[ip->nPend++] = ip->fn;
+  ip->pend[ip->fn] += k;
+  ip->pendInstr    += k;
+}
+
+static void DecoIpcClear(DECO_IPC *ip)
+{
+  for (int i = 0; i < ip->nPend; i++) ip->pend[ip->pendFn[i]] = 0;
+  ip->nPend     = 0;
+  ip->pendInstr = 0;
+}
+
+// Write current window (function with most instructions is shown) and start next one
+static void DecoIpcWinEnd(DECO_IPC *ip)
+{
+  if (ip->winCycles > 0 || ip->winInstr > 0)
+  {
+    int top = -1;
+    for (int i = 0; i < ip->nWinList; i++)
+    {
+      int fn = ip->winList[i];
+      if (top < 0 || ip->winFn[fn] > ip->winFn[top]) top = fn;
+    }
+    fprintf(ip->f, "0x%lX,%lu,%.0lf,%.3lf,%s,%.1lf\n", ip->winStart, ip->winCycles, ip->winInstr,
+            (ip->winCycles > 0) ? ip->winInstr / ip->winCycles : 0.0,
+            (top >= 0 && top < ip->nFn - 1) ? InfoSymGet(top, NULL) : "?",
+            (top >= 0) ? (100.0 * ip->winFn[top]) / ip->winInstr : 0.0);
+    ip->nWin++;
+  }
+  for (int i = 0; i < ip->nWinList; i++) ip->winFn[ip->winList[i]] = 0;
+  ip->nWinList  = 0;
+  ip->winInstr  = 0;
+  ip->winCycles = 0;
+  ip->winStart += ip->window;
+}
+
+// Add part 'frac' of pending instructions and 'cycles' to current window
+static void DecoIpcWinAdd(DECO_IPC *ip, double frac, uint64_t cycles)
+{
+  ip->winCycles += cycles;
+  if (frac <= 0) return;
+  for (int i = 0; i < ip->nPend; i++)
+  {
+    int fn = ip->pendFn[i];
+    if (ip->winFn[fn] == 0) ip->winList[ip->nWinList++] = fn;
+    ip->winFn[fn] += frac * ip->pend[fn];
+  }
+  ip->winInstr += frac * ip->pendInstr;
+}
+
+// Time is not known (error) - pending instructions have no time
+static void DecoIpcLost(DECO_IPC *ip)
+{
+  ip->noTime   += ip->pendInstr;
+  ip->timeValid = 0;
+  DecoIpcClear(ip);
+}
+
+#define DECO_IPC_GAP  64   // More windows between two TSTAMPs are written as one line
+
+// Message with TSTAMP was handled (at 'time'). Cycles since previous TSTAMP
+// are given to instructions decoded since then (split by time windows).
+static void DecoIpcTime(DECO_IPC *ip, uint64_t time)
+{
+  if (!ip->timeValid || time < ip->time)
+  {
+    // First known time (or after a gap): windows are aligned to 'window'
+    DecoIpcLost(ip);
+    DecoIpcWinEnd(ip);
+    ip->winStart  = time - time % ip->window;
+    ip->timeValid = 1;
+    ip->time      = time;
+    return;
+  }
+
+  uint64_t dt = time - ip->time;
+  for (int i = 0; i < ip->nPend; i++)
+  {
+    int fn = ip->pendFn[i];
+    ip->fnInstr[fn]  += ip->pend[fn];
+    ip->fnCycles[fn] += ((double)dt * ip->pend[fn]) / ip->pendInstr;
+  }
+  if (ip->pendInstr == 0) ip->fnCycles[ip->fn] += dt;   // Stall (no instruction retired)
+  ip->cycles += dt;
+  ip->instr  += ip->pendInstr;
+
+  uint64_t t = ip->time;
+  uint64_t nFull = (time >= ip->winStart + ip->window) ? (time - ip->winStart) / ip->window - 1 : 0;
+  if (nFull > DECO_IPC_GAP)
+  {
+    // Big jump of time (like corrupted TSTAMP): first window is written and
+    // all next full windows (before window of 'time') are one '. Gap' line
+    uint64_t end = ip->winStart + ip->window;
+    DecoIpcWinAdd(ip, (double)(end - t) / dt, end - t);
+    t = end;
+    DecoIpcWinEnd(ip);
+
+    end = ip->winStart + nFull * ip->window;
+    fprintf(ip->f, ". Gap: 0x%lX,%lu,%.0lf - %lu windows between two TSTAMPs\n",
+            ip->winStart, end - t, ((double)(end - t) * ip->pendInstr) / dt, nFull);
+    ip->winStart = end;
+    t = end;
+  }
+  while (time >= ip->winStart + ip->window) // Windows ending before 'time'
+  {
+    uint64_t end = ip->winStart + ip->window;
+    DecoIpcWinAdd(ip, (double)(end - t) / dt, end - t);
+    t = end;
+    DecoIpcWinEnd(ip);
+  }
+  DecoIpcWinAdd(ip, (dt > 0) ? (double)(time - t) / dt : 1.0, time - t);
+
+  DecoIpcClear(ip);
+  ip->time = time;
+}
+
+#endif
+
+// Free all memory of decoder
+static void DecoTerm(NexRvDeco *d)
+{
+  CallStack_Free(&d->callStack);
+  free(d->prof);
+  d->prof = NULL;
+  if (d->cov != NULL)
+  {
+    Cov_Free(d->cov);
+    free(d->cov);
+    d->cov = NULL;
+  }
+  if (d->fold != NULL)
+  {
+    free(d->fold->n);
+    free(d->fold);
+    d->fold = NULL;
+  }
+  if (d->ipc != NULL)
+  {
+    DecoIpcFree(d->ipc);
+    d->ipc = NULL;
+  }
+  if (d->hc == NULL) return;
+  free(d->hc->pcs);
+  free(d->hc->infos);
+  free(d->hc);
+  d->hc = NULL;
+}
+
 // This function is called with -1 parameter to reach next BRANCH.
 // Otherwise it is 'n' 16-bit steps (over direct JUMP/CALL as well).
 // It should never step over INDIRECT instruction (RET or JUMP/CALL)
 //  Unless we are in call-stack mode
-static int EmitICNT(FILE *f, int n, Nexus_TypeHist hist, int disp)
+static int EmitICNT(NexRvDeco *d, int n, Nexus_TypeHist hist, int disp)
 {
-  if (nexdeco_pc & 1) return 0;  // Not synchronized ...
+  FILE *f = d->f;
+  int rec = (d->hc != NULL && d->hc->rec);  // Walk is recorded to HIST cache ...
+  int recPcs = (rec && d->hc->recPcs);      // ... with PCs
+
+  if (d->pc & 1) return 0;  // Not synchronized ...
 
-  if ((nexdeco_addrCheck & 1) == 0)
+  if ((d->addrCheck & 1) == 0)
   {
-    if (nexdeco_pc != nexdeco_addrCheck)
+    if (d->pc != d->addrCheck)
     {
-      printf("CALL_CHK: ERROR (pc=0x%lX, expected=0x%lX)\n", nexdeco_pc, nexdeco_addrCheck);
+      printf("CALL_CHK: ERROR (pc=0x%lX, expected=0x%lX)\n", d->pc, d->addrCheck);
     }
     else
     {
@@ -80,18 +720,18 @@ static int EmitICNT(FILE *f, int n, Nexus_TypeHist hist, int disp)
 
   int doneICNT = 0; // Number of done ICNT steps
 
-  if (disp & 1) printf(". PC=0x%lX, EmitICNT(n=%d,hist=0x%x)\n", nexdeco_pc, n, hist);
+  if (disp & 1) printf(". PC=0x%lX, EmitICNT(n=%d,hist=0x%x)\n", d->pc, n, hist);
 
   // Adjust ICNT by what was handled by ResourceFull message[s] before this message (message with normal ICNT field)
-  //  NOTE: resourceFull_ICNT maybe positive or negative!
-  if (n >= 0 && resourceFull_ICNT != 0)
+  //  NOTE: d->resourceFull_ICNT maybe positive or negative!
+  if (n >= 0 && d->resourceFull_ICNT != 0)
   {
-    if (disp & 1) printf(". ICNT adjust: %d to %d\n", n, n + resourceFull_ICNT);
+    if (disp & 1) printf(". ICNT adjust: %d to %d\n", n, n + d->resourceFull_ICNT);
 
-    n += resourceFull_ICNT;
+    n += d->resourceFull_ICNT;
     if (n < 0) return EmitErrorMsg("ICNT adjustment ERROR");
 
-    resourceFull_ICNT = 0;    // Make adjustment 'consumed'
+    d->resourceFull_ICNT = 0;    // Make adjustment 'consumed'
 
   }
 
@@ -111,20 +751,111 @@ static int EmitICNT(FILE *f, int n, Nexus_TypeHist hist, int disp)
 
   while (n != 0)
   {
-    if (f) fprintf(f, "0x%lX", nexdeco_pc);
-    nInstr++; // Statistics (for compression display)
+    int afterLin = 0; // Terminator follows linear instruction of this walk (see -seqjump)
+
+#if 1 // Step over all linear instructions of basic-block (no InfoGet for each of them)
+    INFO_BLOCK blk;
+    if (InfoBlockGet(d->img, d->pc, &blk) && blk.nLin > 0)
+    {
+      unsigned int k  = blk.nLin;
+      unsigned int hw = blk.nHW;
+      if (n > 0 && (unsigned int)n < hw)
+      {
+        // ICNT ends inside of this block - see how many instructions fit
+        k  = 0;
+        hw = 0;
+        while (k < blk.nLin)
+        {
+          InfoAddr a;
+          unsigned int size = (InfoRecGet(blk.rec + k, &a) & INFO_4) ? 2 : 1;
+          if (hw + size > (unsigned int)n) break;
+          hw += size;
+          k++;
+        }
+      }
+
+      if (d->prof) DecoProfRange(d, blk.rec, k);
+      if (d->cov)  DecoCovRange(d, blk.rec, k);
+      if (d->fold)
+      {
+        uint64_t lo;
+        DecoFoldAdd(d->fold, d->img, d->pc, DecoOutRange(d, k, &lo));
+      }
+      if (d->ipc)
+      {
+        uint64_t lo;
+        DecoIpcAdd(d->ipc, d->img, d->pc, DecoOutRange(d, k, &lo));
+      }
+
+      if (f || d->pcBin || d->instrFn || recPcs || (disp & 0x8))  // PC output requested (per-instruction)
+      {
+        for (unsigned int i = 0; i < k; i++)
+        {
+          InfoAddr a;
+          unsigned int info = InfoRecGet(blk.rec + i, &a);
+          const char *t = (info & INFO_4) ? "L4" : "L2";
+
+          if (recPcs) DecoRecInstr(d->hc, a, info);
+          if (d->nInstr + i < d->outFrom || d->nInstr + i >= d->outTo) continue;  // Outside of -from/-count window
+          if (d->instrFn) d->instrFn(d->user, a, info);
+          if (d->pcBin && PcBin_Put(d->pcBin, a) < 0) return EmitErrorMsg("Cannot write PCOUT file");
+          if (f) fprintf(f, "0x%lX", a);
+          if (disp & 0x8) printf("#%lu: PC=0x%lX", d->nInstr + i + 1, a);
+          if (disp & 0x10)
+          {
+            if (f) fprintf(f, ",%s", t);
+            if (disp & 0x8) printf(",%s", t);
+          }
+          if (f) fprintf(f, "\n");
+          if (disp & 0x8) printf("\n");
+        }
+      }
 
-    if (disp & 0x8) printf("#%d: PC=0x%lX", nInstr, nexdeco_pc);
+      d->nInstr   += k;
+      doneICNT    += hw;
+      d->pc       += 2 * hw;
+      afterLin     = (k == blk.nLin);
+      if (n > 0)
+      {
+        n -= hw;
+        if (n == 0) break;  // All done (last instruction was linear)
+      }
+      // Terminator of this block is handled below (one instruction)
+    }
+#endif
+
+    // Output only instructions in -from/-count window
+    int out = (d->nInstr >= d->outFrom && d->nInstr < d->outTo);
+    FILE *fo = out ? f : NULL;
+    int dispPc = out ? disp : (disp & ~0x8);
+
+    if (out && d->pcBin && PcBin_Put(d->pcBin, d->pc) < 0) return EmitErrorMsg("Cannot write PCOUT file");
+    if (fo) fprintf(fo, "0x%lX", d->pc);
+    d->nInstr++; // Statistics (for compression display)
+
+    if (dispPc & 0x8) printf("#%lu: PC=0x%lX", d->nInstr, d->pc);
 
     Nexus_TypeAddr a;
-    unsigned int info = InfoGet(nexdeco_pc, &a);
+    unsigned int info = InfoGet(d->img, d->pc, &a);
     if (info == 0)
     {
-      nexdeco_pc        = 1;  // 1 means, that last address is unknown 
-      nexdeco_lastAddr  = 1;
+      d->pc        = 1;  // 1 means, that last address is unknown 
+      d->lastAddr  = 1;
+      if (d->fold) DecoFoldReset(d->fold);
       return 0;
     }
     if (info == 0) return EmitErrorMsg("info is unknown");
+    if (out && d->instrFn) d->instrFn(d->user, d->pc, info);
+    if (out && d->prof) DecoProfPc(d, d->pc);
+    int covRec = (out && d->cov) ? InfoRecFind(d->img, d->pc) : -1;
+    if (covRec >= 0) Cov_Set(d->cov, COV_EXEC, covRec);
+    if (d->fold)
+    {
+      DecoFoldAdd(d->fold, d->img, d->pc, out);
+      DecoFoldTerm(d->fold, info);
+    }
+    if (d->ipc) DecoIpcAdd(d->ipc, d->img, d->pc, out);
+    if (recPcs) DecoRecInstr(d->hc, d->pc, info);
 
     // Accumulate ICNT we generate (total is returned by this function)
     if (info & INFO_4) doneICNT += 2; else doneICNT += 1;
@@ -157,16 +888,17 @@ static int EmitICNT(FILE *f, int n, Nexus_TypeHist hist, int disp)
         }
       }
 
-      if (info & (INFO_INDIRECT) && !(info & INFO_RET)) t[nt++] = 'I';
+      if (info & INFO_SEQJUMP) t[nt++] = 'S';
+      else if (info & (INFO_INDIRECT) && !(info & INFO_RET)) t[nt++] = 'I';
       if (info & INFO_4) t[nt++] = '4'; else t[nt++] = '2';
       t[nt] = '\0';
-      if (f) fprintf(f, ",%s", t);
+      if (fo) fprintf(fo, ",%s", t);
 
-      if (disp & 0x8) printf(",%s", t);
+      if (dispPc & 0x8) printf(",%s", t);
     }
-    if (f) fprintf(f, "\n");
+    if (fo) fprintf(fo, "\n");
 
-    if (disp & 0x8) printf("\n");
+    if (dispPc & 0x8) printf("\n");
 
     if (n > 0)
     {
@@ -175,30 +907,38 @@ static int EmitICNT(FILE *f, int n, Nexus_TypeHist hist, int disp)
       if (n < 0) return EmitErrorMsg("ICNT too small");
     }
 
-    if (conf_CallStack > 0 && (info & INFO_CALL))
+    if (d->callStack.conf > 0 && (info & INFO_CALL))
     {
       // This is call (direct or indirect) push address after '[c]jal[r]) to the stack
-      Nexus_TypeAddr ret = nexdeco_pc + ((info & INFO_4) ? 4 : 2);
-      CallStack_Push(ret);
+      Nexus_TypeAddr ret = d->pc + ((info & INFO_4) ? 4 : 2);
+      CallStack_Push(&d->callStack, ret);
+      if (rec) DecoRecPush(d->hc, ret);
+    }
+
+    if ((info & INFO_SEQJUMP) && d->seqJump && afterLin)
+    {
+      // Sequential jump with 'lui/auipc' in this walk (encoder did not report it)
+      info &= ~INFO_INDIRECT;
     }
 
     if (info & INFO_INDIRECT) // Cannot continue over indirect...
     {
       // We always pop the stack if we see RET ...
-      if (conf_CallStack > 0 && (info & INFO_RET))
+      if (d->callStack.conf > 0 && (info & INFO_RET))
       {
-        Nexus_TypeAddr ret = CallStack_Pop();
-        // nexdeco_addrCheck = ret;  // Set PC to be checked (next time)
-        if (conf_CallStack > 0)
+        Nexus_TypeAddr ret = CallStack_Pop(&d->callStack);
+        if (rec) d->hc->bad = 1;  // Walk depends on call-stack content (cannot be cached)
+        // d->addrCheck = ret;  // Set PC to be checked (next time)
+        if (d->callStack.conf > 0)
         {
-          nexdeco_pc = ret;
+          d->pc = ret;
         }
         if (n != 0)
         {
           // We should continue from PC we just pop from the stack 
           if (ret == 1)
           {
-            return EmitErrorMsg("Not enough entires on callstack");
+            return EmitErrorMsg("Not enough entries on callstack (decoder needs -cs of encoder)");
           }
           continue;
         }
@@ -233,73 +973,122 @@ static int EmitICNT(FILE *f, int n, Nexus_TypeHist hist, int disp)
           n = 0;  // This will stop the loop (when we were called with HIST only)
         }
       }
+      if (covRec >= 0) Cov_Set(d->cov, (info & INFO_JUMP) ? COV_TAKEN : COV_NTAKEN, covRec);
     }
 
-    if (info & INFO_JUMP)   nexdeco_pc = a;   // Direct jump/call/branch
-    else if (info & INFO_4) nexdeco_pc += 4;  // Linear 4 or 2 otherwise
-    else                    nexdeco_pc += 2;
+    if (info & INFO_JUMP)   d->pc = a;   // Direct jump/call/branch
+    else if (info & INFO_4) d->pc += 4;  // Linear 4 or 2 otherwise
+    else                    d->pc += 2;
   }
 
   return doneICNT;  // Number of ICNT steps done (usually at least 1, but can be 0)
 }
 
-#define MSGFIELDS_MAX   10 // Some reasonable limit
-
-static int              msgFieldPos = 0;
-static Nexus_TypeField  msgFields[MSGFIELDS_MAX];
-static Nexus_TypeField  savedFields[MSGFIELDS_MAX];
-static int              msgFieldCnt = 0;
-
-static int NexusFieldGet(const char *name, Nexus_TypeField *p)
-{
-  for (int d = msgFieldPos; nexusMsgDef[d].def != 1; d++)
-  {
-    if (strcmp(nexusMsgDef[d].name, name) == 0)
-    {
-      int fi = d - msgFieldPos;
-      if (fi > msgFieldCnt) *p = 0;
-      else      *p = msgFields[fi];
-      return 1; // OK
-    }
-  }
-  return 0;
-}
-
-unsigned int conf_src = 0;
-
-#define NEX_FLDGET(n) Nexus_TypeField n = 0; if (!NexusFieldGet(#n, &n)) return (-1)
-
-static const Nexus_TypeAddr msb_mask = ((Nexus_TypeAddr)1UL) << 49;
+// Get field of current message ('return -1' if it is not in message definition)
+#define NEX_FLDGET(n) Nexus_TypeField n = d->msgFields[NEXF_##n]; \
+                      if (!(nexusMsgSlots[TCODE] & (1u << NEXF_##n))) return (-1)
 
+// U-ADDR/F-ADDR field is already MSB-extended (see -msbext in DecoByte)
 static Nexus_TypeAddr CalculateAddr(Nexus_TypeAddr fu_addr, int full, Nexus_TypeAddr prev_addr)
 {
   fu_addr <<= NEXUS_PARAM_AddrSkip; // LSB bit is never sent
-  if ((fu_addr >> 32) & 0x10000)           // Perform MSB extension
-  {
-    fu_addr |= 0xFFFF000000000000UL;
-  }
   // Update (NEW or XOR)
   if (!full) 
     fu_addr ^= prev_addr;
   // printf("NADDR=0x%lX\n", fu_addr);
   return fu_addr;
 }
-static int MsgHandle(FILE *f, int disp)
+// Same as EmitICNT(d, -1, hist, disp), but result is taken from cache (if possible)
+static int DecoHistWalk(NexRvDeco *d, Nexus_TypeHist hist, int disp)
 {
-  int doneICNT;
-  
-  int TCODE = msgFields[0];
-  if (0 && msgFields[1] != conf_src)      // Is this SRC we are looking for
+  if ((disp & 0x19) != 0 || (d->pc & 1)) return EmitICNT(d, -1, hist, disp);  // Per-instruction display
+  if (d->cov) return EmitICNT(d, -1, hist, disp);   // Branch directions are not cached
+  if (d->ipc) return EmitICNT(d, -1, hist, disp);   // Functions of cached walk are not known
+
+  DECO_HCACHE *hc = d->hc;
+  if (hc == NULL)
+  {
+    hc = (DECO_HCACHE *)calloc(1, sizeof(DECO_HCACHE));
+    if (hc == NULL) return EmitICNT(d, -1, hist, disp);
+    for (int k = 0; k < DECO_HCACHE_SIZE; k++) hc->e[k].pc = 1;
+    d->hc = hc;
+  }
+
+  int out = (d->f || d->pcBin || d->instrFn || d->prof);
+  DECO_HWALK *e = &hc->e[((d->pc >> 1) ^ (hist * 2654435761u)) & (DECO_HCACHE_SIZE - 1)];
+  int again = (e->pc == d->pc && e->hist == hist);
+  if (again && (!out || e->slice >= 0) && !(d->fold && e->nPush > 0))  // Calls are followed by -folded
+  {
+    hc->hits++;
+    if (d->fold)
+    {
+      uint64_t lo;
+      DecoFoldAdd(d->fold, d->img, d->pc, DecoOutRange(d, e->nInstr, &lo));
+    }
+    if (out)
+    {
+      // Replay PCs of the walk (only these in -from/-count window)
+      for (int i = 0; i < e->nInstr; i++)
+      {
+        if (d->nInstr + i < d->outFrom || d->nInstr + i >= d->outTo) continue;
+        Nexus_TypeAddr a = hc->pcs[e->slice + i];
+        if (d->pcBin && PcBin_Put(d->pcBin, a) < 0) return EmitErrorMsg("Cannot write PCOUT file");
+        if (d->f) fprintf(d->f, "0x%lX\n", a);
+        if (d->instrFn) d->instrFn(d->user, a, hc->infos[e->slice + i]);
+        if (d->prof) DecoProfPc(d, a);
+      }
+    }
+    d->nInstr += e->nInstr;
+    for (int k = 0; k < e->nPush; k++)
+    {
+      CallStack_Push(&d->callStack, e->push[k]);
+    }
+    d->pc = e->exitPc;
+    return e->nHW;
+  }
+
+  // Not in cache - walk it (and record the walk). PCs are recorded only when
+  // the walk is seen second time (most of walks are never repeated).
+  hc->misses++;
+  if (hc->full) DecoHistFlush(hc);
+  Nexus_TypeAddr pc = d->pc;
+  uint64_t nInstr   = d->nInstr;
+  int slice         = hc->nPcs;
+  hc->cur.nPush     = 0;
+  hc->bad           = 0;
+  hc->rec           = 1;
+  hc->recPcs        = again;
+  int ret = EmitICNT(d, -1, hist, disp);
+  hc->rec           = 0;
+
+  if (ret < 0 || hc->bad || (d->pc & 1))
   {
-    return 0; // Ignore, but mark as handled
+    hc->nPcs = slice; // Not cached
+    return ret;
   }
 
+  *e        = hc->cur;
+  e->pc     = pc;
+  e->hist   = hist;
+  e->exitPc = d->pc;
+  e->nHW    = ret;
+  e->nInstr = (int)(d->nInstr - nInstr);
+  e->slice  = again ? slice : -1;
+  return ret;
+}
+
+static int MsgHandle(NexRvDeco *d, int disp)
+{
+  int doneICNT;
+  
+  int TCODE = d->msgFields[NEXF_TCODE];
+
   switch (TCODE)
   {
     case NEXUS_TCODE_DirectBranch:
       {
         NEX_FLDGET(ICNT);
-        doneICNT = EmitICNT(f, ICNT, 0x0, disp);
+        doneICNT = EmitICNT(d, ICNT, 0x0, disp);
         if (doneICNT < 0) return doneICNT;
       }
       break;
@@ -309,10 +1098,10 @@ static int MsgHandle(FILE *f, int disp)
         // NEX_FLDGET(BTYPE); // We ignore this for now
         NEX_FLDGET(ICNT);
         NEX_FLDGET(UADDR);
-        doneICNT = EmitICNT(f, ICNT, 0x0, disp);
+        doneICNT = EmitICNT(d, ICNT, 0x0, disp);
         if (doneICNT < 0) return doneICNT;
-        nexdeco_lastAddr = CalculateAddr(UADDR, 0, nexdeco_lastAddr);
-        nexdeco_pc = nexdeco_lastAddr;
+        d->lastAddr = CalculateAddr(UADDR, 0, d->lastAddr);
+        d->pc = d->lastAddr;
       }
       break;
 
@@ -322,10 +1111,11 @@ static int MsgHandle(FILE *f, int disp)
         NEX_FLDGET(ICNT);
         NEX_FLDGET(FADDR);
 
-        doneICNT = EmitICNT(f, ICNT, 0x0, disp);
+        doneICNT = EmitICNT(d, ICNT, 0x0, disp);
         if (doneICNT < 0) return doneICNT;
-        nexdeco_lastAddr = CalculateAddr(FADDR, 1, nexdeco_lastAddr);
-        nexdeco_pc = nexdeco_lastAddr;
+        CallStack_Init(&d->callStack, d->callStack.conf);  // Sync resets call-stack
+        d->lastAddr = CalculateAddr(FADDR, 1, d->lastAddr);
+        d->pc = d->lastAddr;
       }
       break;
 
@@ -334,10 +1124,11 @@ static int MsgHandle(FILE *f, int disp)
         // NEX_FLDGET(SYNC); // We ignore this for now
         NEX_FLDGET(ICNT);
         NEX_FLDGET(FADDR);
-        doneICNT = EmitICNT(f, ICNT, 0x0, disp);
+        doneICNT = EmitICNT(d, ICNT, 0x0, disp);
         if (doneICNT < 0) return doneICNT;
-        nexdeco_lastAddr = CalculateAddr(FADDR, 1, nexdeco_lastAddr);
-        nexdeco_pc = nexdeco_lastAddr;
+        CallStack_Init(&d->callStack, d->callStack.conf);  // Sync resets call-stack
+        d->lastAddr = CalculateAddr(FADDR, 1, d->lastAddr);
+        d->pc = d->lastAddr;
       }
       break;
 
@@ -347,10 +1138,11 @@ static int MsgHandle(FILE *f, int disp)
         // NEX_FLDGET(BTYPE); // We ignore this for now
         NEX_FLDGET(ICNT);
         NEX_FLDGET(FADDR);
-        doneICNT = EmitICNT(f, ICNT, 0x0, disp);
+        doneICNT = EmitICNT(d, ICNT, 0x0, disp);
         if (doneICNT < 0) return doneICNT;
-        nexdeco_lastAddr = CalculateAddr(FADDR, 1, nexdeco_lastAddr);
-        nexdeco_pc = nexdeco_lastAddr;
+        CallStack_Init(&d->callStack, d->callStack.conf);  // Sync resets call-stack
+        d->lastAddr = CalculateAddr(FADDR, 1, d->lastAddr);
+        d->pc = d->lastAddr;
       }
       break;
 
@@ -361,10 +1153,10 @@ static int MsgHandle(FILE *f, int disp)
         NEX_FLDGET(UADDR);
         NEX_FLDGET(HIST);
 
-        doneICNT = EmitICNT(f, ICNT, HIST, disp);
+        doneICNT = EmitICNT(d, ICNT, HIST, disp);
         if (doneICNT < 0) return doneICNT;
-        nexdeco_lastAddr = CalculateAddr(UADDR, 0, nexdeco_lastAddr);
-        nexdeco_pc = nexdeco_lastAddr;
+        d->lastAddr = CalculateAddr(UADDR, 0, d->lastAddr);
+        d->pc = d->lastAddr;
       }
       break;
 
@@ -377,10 +1169,11 @@ static int MsgHandle(FILE *f, int disp)
         NEX_FLDGET(FADDR);
         NEX_FLDGET(HIST);
 
-        doneICNT = EmitICNT(f, ICNT, HIST, disp);
+        doneICNT = EmitICNT(d, ICNT, HIST, disp);
         if (doneICNT < 0) return doneICNT;
-        nexdeco_lastAddr = CalculateAddr(FADDR, 1, nexdeco_lastAddr);
-        nexdeco_pc = nexdeco_lastAddr;
+        CallStack_Init(&d->callStack, d->callStack.conf);  // Sync resets call-stack
+        d->lastAddr = CalculateAddr(FADDR, 1, d->lastAddr);
+        d->pc = d->lastAddr;
       }
       break;
 
@@ -401,18 +1194,18 @@ static int MsgHandle(FILE *f, int disp)
           if (RDATA > 1)
           {
             // Special calling to emit HIST only ...
-            if (dispHistRepeat)
+            if (d->dispHistRepeat)
             {
-              if (disp & 4) printf("RepeatHIST,0x%lX,%d\n", RDATA, dispHistRepeat);            
-              dispHistRepeat = 0;
+              if (disp & 4) printf("RepeatHIST,0x%lX,%d\n", RDATA, d->dispHistRepeat);            
+              d->dispHistRepeat = 0;
             }
             do
             {
               // ICNT is unknown (-1), what will process only HIST bits
-              doneICNT = EmitICNT(f, -1, RDATA, disp);
+              doneICNT = DecoHistWalk(d, RDATA, disp);
               if (doneICNT < 0) return doneICNT;
 
-              resourceFull_ICNT -= doneICNT;  // Consume, so next time ICNT will be adjusted
+              d->resourceFull_ICNT -= doneICNT;  // Consume, so next time ICNT will be adjusted
               hRepeat--;
             } while (hRepeat > 0);
           }
@@ -423,33 +1216,54 @@ static int MsgHandle(FILE *f, int disp)
           // This is I-CNT overflow
           NEX_FLDGET(RDATA);
 
-          resourceFull_ICNT += (int)RDATA;  // Accumulate, so next time ICNT will be adjusted
+          d->resourceFull_ICNT += (int)RDATA;  // Accumulate, so next time ICNT will be adjusted
         }
       }
       break;
 
     case NEXUS_TCODE_ProgTraceCorrelation:
       {
-        NEX_FLDGET(EVCODE);
+        // NEX_FLDGET(EVCODE); // We ignore this for now
         NEX_FLDGET(CDF);
         NEX_FLDGET(ICNT);
         if (CDF == 1)
         {
           NEX_FLDGET(HIST);
-          doneICNT = EmitICNT(f, ICNT, HIST, disp);
+          doneICNT = EmitICNT(d, ICNT, HIST, disp);
           if (doneICNT < 0) return doneICNT;
         }
         else
         {
           // No history ...
-          doneICNT = EmitICNT(f, ICNT, 0, disp);
+          doneICNT = EmitICNT(d, ICNT, 0, disp);
           if (doneICNT < 0) return doneICNT;
         }
-        nexdeco_pc = nexdeco_lastAddr;
+        d->pc = d->lastAddr;
       }
       break;
 
 
+    case NEXUS_TCODE_Ownership:
+      {
+        // Next instructions are in code image of this process (PC ranges
+        // of processes may overlap). Encoder sends it after sync message.
+        NEX_FLDGET(PROCESS);
+        d->process      = PROCESS;
+        d->processValid = 1;
+        if (disp & 2) printf("PROCESS=0x%lX\n", PROCESS);
+        const InfoImage *img = InfoProcessImage(PROCESS);
+        if (img != d->img)
+        {
+          // Cached walks and function are of previous image (and call-tree
+          // of -folded is of previous process, so next code starts at root)
+          d->img = img;
+          if (d->hc != NULL) DecoHistFlush(d->hc);
+          if (d->ipc != NULL) d->ipc->fnHi = 0;
+          if (d->fold != NULL) DecoFoldReset(d->fold);
+        }
+      }
+      break;
+
     case NEXUS_TCODE_Error:
       // We ignore these now - these are either at very end
       // or are followed by full-sync
@@ -463,36 +1277,114 @@ static int MsgHandle(FILE *f, int disp)
   return 0;
 }
 
-// This function is an extension of 'NexusDump'
-// It adds all fields (for each message) into fldArray and at end of each message
-// it calls 'MsgHandle()' function.
-int NexusDeco(FILE *f, int disp)
+// Count ICNT and HIST of message without PC reconstruction (for -stat-fast).
+// ICNT of ResourceFull with HIST is included in ICNT of next message, so sum
+// of ICNT fields (and RDATA of RCODE=0) is exact number of 16-bit units.
+static void DecoCount(NexRvDeco *d)
 {
-  int fldDef = -1;
-  int fldBits = 0;
-  Nexus_TypeField fldVal = 0;
+  Nexus_TypeField hist    = d->msgFields[NEXF_HIST];
+  Nexus_TypeField hRepeat = 1;
 
-  int msgCnt = 0;
-  int msgBytes = 0;
-  int msgErrors = 0;
+  d->nHW += d->msgFields[NEXF_ICNT];  // It is 0 if message has no ICNT
+  if (d->msgFields[NEXF_TCODE] == NEXUS_TCODE_ResourceFull)
+  {
+    if (d->msgFields[NEXF_RCODE] == 0) d->nHW += d->msgFields[NEXF_RDATA];  // ICNT overflow
+    else                               hist = d->msgFields[NEXF_RDATA];
+    if (d->msgFields[NEXF_RCODE] == 2) hRepeat = d->msgFields[NEXF_HREPEAT];
+  }
 
-  // Make sure decoder is using real call-stack ...
-  if (conf_CallStack < 0)
+  int n = 0;
+  while (hist > 1)  // Bits below stop-bit
   {
-    conf_CallStack = -conf_CallStack;
+    hist >>= 1;
+    n++;
   }
-  CallStack_Init();
+  d->nBranch += n * hRepeat;
+}
 
-  msgFieldCnt = 0;  // No fields
+// Is it TCODE of synchronizing message (with SYNC and FADDR fields)?
+static int IsSyncTcode(unsigned int tcode)
+{
+  return tcode == NEXUS_TCODE_ProgTraceSync || tcode == NEXUS_TCODE_DirectBranchSync ||
+         tcode == NEXUS_TCODE_IndirectBranchSync || tcode == NEXUS_TCODE_IndirectBranchHistSync;
+}
 
-  unsigned char msgByte = 0;
-  unsigned char prevByte = 0;
-  for (;;)
+// TSTAMP of message is absolute in sync messages and relative (to previous
+// message with TSTAMP) in other messages. Time is not known before first sync.
+static void DecoTstamp(NexRvDeco *d, int syncMsg, int disp)
+{
+  Nexus_TypeField ts = d->msgFields[NEXF_TSTAMP];
+  if (syncMsg)
+  {
+    if (d->nTstamp == 0) d->timeFirst = ts;
+    d->time      = ts;
+    d->timeValid = 1;
+  }
+  else
   {
-    prevByte = msgByte;
-    if (fread(&msgByte, 1, 1, fNex) != 1) break;  // EOF
+    d->time += ts;
+  }
+  if (!d->timeValid) return;
+  if (!d->lastMsg) d->nTstamp++;  // Last message of segment is counted by next segment
+  if (disp & 2) printf("TIME=%lu\n", d->time);
+}
 
-/*
+#if 1 // Recovery from errors (-resync)
+
+// Error in DecoByte: rest of message and all messages till next sync message
+// are skipped (PC is not known till then). Returns 0 (or 'err' if not enabled).
+static int DecoResync(NexRvDeco *d, int err)
+{
+  if (!d->resync) return err;
+
+  if (!d->waitSync)
+  {
+    d->timeValid = 0;   // TSTAMP of broken message is lost (time is known again after sync)
+    d->errPos   = (d->fldDef >= 0) ? d->msgPos : d->bytePos - 1;
+    d->waitSync = 1;
+    d->nGaps++;
+
+    // ICNT of next message includes units already walked by HIST of
+    // ResourceFull messages (negative adjustment) or ICNT overflows
+    d->lostHW += (uint64_t)(int64_t)d->resourceFull_ICNT;
+  }
+  d->skipMsg = ((d->prevByte & 0x3) != 0x3);  // Error was not at end of message
+  d->fldDef  = -1;
+  d->fldBits = 0;
+  d->fldVal  = 0;
+
+  d->pc                = 1;
+  d->addrCheck         = 1;
+  d->lastAddr          = 1;
+  d->resourceFull_ICNT = 0;
+  CallStack_Init(&d->callStack, d->callStack.conf);
+  if (d->fold) DecoFoldReset(d->fold);
+  if (d->ipc) DecoIpcLost(d->ipc);
+  return 0;
+}
+
+// End of gap (at sync message or at end of trace)
+static void DecoResyncEnd(NexRvDeco *d, uint64_t pos, int disp)
+{
+  d->waitSync = 0;
+  d->lostBytes += pos - d->errPos;
+  if (disp & 4) printf("NexRv/Resync: 0x%lX: %lu bytes skipped\n", d->errPos, pos - d->errPos);
+}
+
+#endif
+
+// This function is an extension of 'NexusDump' (for one byte)
+// It adds all fields (for each message) into fldArray and at end of each message
+// it calls 'MsgHandle()' function.
+// Returns <0 for error, 1 if decoding should stop and 0 otherwise. Decoding stops
+// after message which starts at 'd->endPos' (or later) or after 'd->outTo' instructions.
+static int DecoByte(NexRvDeco *d, unsigned char msgByte, int disp)
+{
+  unsigned char prevByte = d->prevByte;
+  d->prevByte = msgByte;
+  d->bytePos++;
+
+/*
  
 . 0x70 011100_00: TCODE[6]=28 (MSG #41) - IndirectBranchHist
 . 0x10 000100_00: BTYPE[2]=0x0
@@ -507,203 +1399,1429 @@ int NexusDeco(FILE *f, int disp)
  */     
 
 #if 0 // Some debug code (it make one of tests fail!)
-      if (1 && msgCnt == 42 && prevByte == 0xFC && msgByte == 0xFF)
-      {
-        msgByte = 0x6b;
-      }
+    if (1 && d->msgCnt == 42 && prevByte == 0xFC && msgByte == 0xFF)
+    {
+      msgByte = 0x6b;
+    }
 #endif      
 
 #if 1 // This will skip long sequnece of idles (visible in true captures ...)
-    if (msgByte == 0xFF && prevByte == 0xFF)
+  if (msgByte == 0xFF && prevByte == 0xFF)
+  {
+    return 0;
+  }
+#endif
+
+  if (d->skipMsg)
+  {
+    // Rest of broken message (-resync)
+    if ((msgByte & 0x3) == 0x3) d->skipMsg = 0;
+    return 0;
+  }
+
+  if (disp & 1)
+  {
+    if (d->msgCnt > 0 && d->fldDef < 0)
     {
-      continue;
+      printf(". \n");
     }
-#endif
+    printf(". 0x%02X ", msgByte);
+    for (int b = 0x80; b != 0; b >>= 1)
+    {
+      if (b == 0x2) printf("_");
+      if (msgByte & b) printf("1"); else printf("0");
+    }
+    printf(":");
+  }
+
+  unsigned int mdo = msgByte >> 2;
+  unsigned int mseo = msgByte & 0x3;
 
+  if (mseo == 0x2)
+  {
+    printf(" ERROR: MSEO='10' is not allowed\n");
+    return -1;  // Error return
+  }
 
-    if (disp & 1)
+  if (d->fldDef < 0)
+  {
+    if (mseo == 0x3)
     {
-      if (msgCnt > 0 && fldDef < 0)
-      {
-        printf(". \n");
-      }
-      printf(". 0x%02X ", msgByte);
-      for (int b = 0x80; b != 0; b >>= 1)
-      {
-        if (b == 0x2) printf("_");
-        if (msgByte & b) printf("1"); else printf("0");
-      }
-      printf(":");
+      if (disp & 1) printf(" IDLE\n");
+      return 0;
     }
 
-    unsigned int mdo = msgByte >> 2;
-    unsigned int mseo = msgByte & 0x3;
+    if (mseo != 0x0)
+    {
+      printf(" ERROR: Message must start from MSEO='00'\n");
+      return -2;  // Error return
+    }
 
-    if (mseo == 0x2)
+    d->msgPos = d->bytePos - 1;
+    if (d->msgPos >= d->endPos)
     {
-      printf(" ERROR: MSEO='10' is not allowed\n");
-      return -1;  // Error return
+      d->lastMsg   = 1;  // This is last message (it will end this segment)
+      d->lastCnt   = d->msgCnt;
+      d->lastBytes = d->msgBytes;
+      d->lastHW    = d->nHW;
     }
 
-    if (fldDef < 0)
+    d->fldDef = nexusMsgTcode[mdo];
+
+    if (d->fldDef < 0)
     {
-      if (mseo == 0x3)
-      {
-        if (disp & 1) printf(" IDLE\n");
-        continue;
-      }
+      printf(" ERROR: Message with TCODE=%d is not defined for RISC-V\n", mdo);
+      return -3;
+    }
+
+    // Special handling for RepeatBranch message. 
+    // We want to preserve previous packet, so we can
+    // repeat it at end of RepeatBranch handling.
+    if (mdo == NEXUS_TCODE_RepeatBranch)
+    {
+      // Save previous message fields
+      memcpy(d->savedFields, d->msgFields, sizeof(d->msgFields));
+    }
+
+    // Save to allow later decoding (fields not present in message will be 0)
+    memset(d->msgFields, 0, sizeof(d->msgFields));
+    d->msgFields[NEXF_TCODE] = mdo;
+    d->msgTstamp = 0;
+
+    if (disp & 3) printf(" TCODE[6]=%d (MSG #%d) - %s\n", mdo, d->msgCnt, nexusMsgDef[d->fldDef].name);
+    d->msgCnt++;
+    d->msgBytes++;
+    d->tcodeCnt[mdo]++;
+
+    if (mdo == NEXUS_TCODE_Error) d->msgErrors++;
+
+    d->fldDef++;
+    d->fldBits = 0;
+    d->fldVal = 0;
+    return 0;
+  }
+
+  // Accumulate 'mdo' to field value
+  d->fldVal |= (((Nexus_TypeField)mdo) << d->fldBits);
+  d->fldBits += 6;
+
+  d->msgBytes++;
+
+  // Process fixed size fields (there may be more than one in one MDO record)
+  while (nexusMsgDef[d->fldDef].def & 0x200)
+  {
+    int fldSize = nexusMsgDef[d->fldDef].def & 0xFF;
+    if (fldSize & 0x80)
+    {
+      // Size of this field is defined by parameter (only SRC is such)
+      fldSize = d->srcBits;
+    }
+    if (d->fldBits < fldSize)
+    {
+      break;  // Not enough bits for this field
+    }
+
+    d->msgFields[nexusMsgDef[d->fldDef].fld] = d->fldVal & ((((Nexus_TypeField)1) << fldSize) - 1); // Save field
+
+    if ((disp & 1) && fldSize > 0) printf(" %s[%d]=0x%lX", nexusMsgDef[d->fldDef].name, fldSize, d->fldVal & ((((Nexus_TypeField)1) << fldSize) - 1));
+    d->fldDef++;
+    d->fldVal >>= fldSize;
+    d->fldBits -= fldSize;
+  }
+
+  if (mseo == 0x0)
+  {
+    if (disp & 1) printf("\n");
+    return 0;
+  }
+
+  if (nexusMsgDef[d->fldDef].def & 0x400)
+  {
+    // Variable size field
+    if (disp & 1) printf(" %s[%d]=0x%lX\n", nexusMsgDef[d->fldDef].name, d->fldBits, d->fldVal);
+
+    int fld = nexusMsgDef[d->fldDef].fld;
+    if (d->msbExt && (fld == NEXF_UADDR || fld == NEXF_FADDR) && d->fldBits > 0 && d->fldBits < 64 &&
+        ((d->fldVal >> (d->fldBits - 1)) & 1))
+    {
+      d->fldVal |= ~(Nexus_TypeField)0 << d->fldBits;  // Extend MSB of last MDO (trTeInstExtendAddrMSB)
+    }
+    d->msgFields[fld] = d->fldVal; // Save field
+    if (fld == NEXF_TSTAMP) d->msgTstamp = 1;
+
+    if (mseo == 3)
+    {
+      int cnt = 1;
+      int syncMsg = IsSyncTcode((unsigned int)d->msgFields[NEXF_TCODE]);
+
+      d->dispHistRepeat = 0; 
 
-      if (mseo != 0x0)
+      if (d->msgTstamp) DecoTstamp(d, syncMsg, disp);  // Before RepeatBranch restores previous message
+
+      if (d->msgFields[NEXF_TCODE] == NEXUS_TCODE_RepeatBranch)
       {
-        printf(" ERROR: Message must start from MSEO='00'\n");
-        return -2;  // Error return
+        // Special handling for repeat branch (which only has 1 field!)
+        cnt = d->msgFields[NEXF_BCNT]; // Counter set in RepeatBranch message
+        memcpy(d->msgFields, d->savedFields, sizeof(d->msgFields)); // Restore previous message (saved)
+        d->dispHistRepeat = cnt;
       }
 
-      // TODO: Convert to look-up table (for all TCODE values)
-      for (int d = 0; nexusMsgDef[d].def != 0; d++)
+      while (cnt > 0) // Handle (1 or many times ...)
       {
-        if ((nexusMsgDef[d].def & 0x100) == 0) continue;
-        if ((nexusMsgDef[d].def & 0xFF) == mdo)
+        uint64_t nHW = d->nHW;
+        DecoCount(d);
+        if (d->waitSync)
         {
-          fldDef = d; // Found TCODE
-          break;
+          // Instructions of skipped message are lost (also ICNT of sync message)
+          d->lostHW += d->nHW - nHW;
+          if (syncMsg) DecoResyncEnd(d, d->msgPos, disp);
+        }
+        if (d->statFast != 1 && !d->waitSync)
+        {
+          int err = MsgHandle(d, disp);
+          if (err < 0) return err;
         }
+        cnt--;
       }
 
-      if (fldDef < 0)
+      if (d->ipc && d->msgTstamp && d->timeValid) DecoIpcTime(d->ipc, d->time);
+
+      if (syncMsg && d->fIdx != NULL && (d->pc & 1) == 0)
       {
-        printf(" ERROR: Message with TCODE=%d is not defined for RISC-V\n", mdo);
-        return -3;
+        // Decoding may start from this message (see NexusIndex)
+        fprintf(d->fIdx, "0x%lX,%lu,0x%lX", d->msgPos, d->nInstr, d->pc);
+        if (d->processValid) fprintf(d->fIdx, ",0x%lX", d->process);
+        fprintf(d->fIdx, "\n");
       }
 
-      // Special handling for RepeatBranch message. 
-      // We want to preserve previous packet, so we can
-      // repeat it at end of RepeatBranch handling.
-      if (mdo == NEXUS_TCODE_RepeatBranch)
-      {
-        // Save previous message fields
-        savedFields[0] = msgFieldPos;
-        savedFields[1] = msgFieldCnt;
-        savedFields[2] = msgFields[0];
-        savedFields[3] = msgFields[1];
-        savedFields[4] = msgFields[2];
-        savedFields[5] = msgFields[3];
-        savedFields[6] = msgFields[4];
-      }
-
-      // Save to allow later decoding
-      msgFieldPos = fldDef;
-      msgFieldCnt = 0;
-      msgFields[msgFieldCnt++] = mdo;
-
-      if (disp & 3) printf(" TCODE[6]=%d (MSG #%d) - %s\n", mdo, msgCnt, nexusMsgDef[fldDef].name);
-      msgCnt++;
-      msgBytes++;
-
-      if (mdo == NEXUS_TCODE_Error) msgErrors++;
-
-      fldDef++;
-      fldBits = 0;
-      fldVal = 0;
-      continue;
+      d->fldDef = -1;
+      if (d->lastMsg || d->nInstr >= d->outTo) return 1;  // Stop here
     }
+    else
+    {
+      d->fldDef = NexusMsgNextVar(d->fldDef, d->msgFields);
+    }
+    d->fldBits = 0;
+    d->fldVal = 0;
+    return 0;
+  }
+
+  if (d->fldBits > 0)
+  {
+    printf(" ERROR: Not enough bits for non-variable field\n");
+    return -4;
+  }
+  return 0;
+}
+
+#if 1 // Library API (see NexRvDeco.h)
 
-    // Accumulate 'mdo' to field value
-    fldVal |= (((Nexus_TypeField)mdo) << fldBits);
-    fldBits += 6;
+NexRvDeco *NexRvDeco_Create(NexRvDeco_InstrFn fn, void *user)
+{
+  NexRvDeco *d = (NexRvDeco *)malloc(sizeof(NexRvDeco));
+  if (d == NULL) return NULL;
+
+#if NEXRV_THREADS
+  // TCODE look-up table is built once (instances may run on other threads)
+  static pthread_once_t msgOnce = PTHREAD_ONCE_INIT;
+  pthread_once(&msgOnce, NexusMsgInit);
+#else
+  NexusMsgInit();   // TCODE look-up table (built by first call only)
+#endif
 
-    msgBytes++;
+  DecoInit(d, NULL, NULL, CALLSTACK_DEFAULT);
+  if (d->callStack.conf == 0)
+  {
+    free(d);  // No memory for call-stack
+    return NULL;
+  }
+  d->instrFn = fn;
+  d->user    = user;
+  return d;
+}
 
-    // Process fixed size fields (there may be more than one in one MDO record)
-    while (nexusMsgDef[fldDef].def & 0x200)
+int NexRvDeco_Feed(NexRvDeco *d, const unsigned char *p, size_t len)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    int ret = DecoByte(d, p[i], 0);
+    if (ret < 0) ret = DecoResync(d, ret);
+    if (ret < 0) return ret;
+    if (p[i] == 0xFF)
     {
-      int fldSize = nexusMsgDef[fldDef].def & 0xFF;
-      if (fldSize & 0x80)
-      {
-        // Size of this field is defined by parameter ...
-        fldSize = 2;
-      }
-      if (fldBits < fldSize)
-      {
-        break;  // Not enough bits for this field
-      }
+      // Following idles are skipped in bulk (DecoByte would ignore them)
+      size_t n = NexRvScan_Idle(p + i + 1, len - i - 1);
+      i += n;
+      d->bytePos += n;
+    }
+  }
+  return 0;
+}
+
+int NexRvDeco_Flush(NexRvDeco *d)
+{
+  if (d->waitSync) DecoResyncEnd(d, d->bytePos, 0);
+  if (d->fldDef < 0) return 0;  // Stream ends between messages
+
+  d->fldDef  = -1;              // Drop incomplete message
+  d->fldBits = 0;
+  d->fldVal  = 0;
+  return -1;
+}
+
+void NexRvDeco_Reset(NexRvDeco *d)
+{
+  NexRvDeco_InstrFn fn = d->instrFn;
+  void *user = d->user;
+  int resync = d->resync;
+  int seqJump = d->seqJump;
+  int msbExt  = d->msbExt;
+  DecoTerm(d);
+  DecoInit(d, NULL, NULL, d->callStack.conf);
+  d->instrFn = fn;
+  d->user    = user;
+  d->resync  = resync;
+  d->seqJump = seqJump;
+  d->msbExt  = msbExt;
+}
+
+uint64_t NexRvDeco_InstrCount(const NexRvDeco *d)
+{
+  return d->nInstr;
+}
+
+void NexRvDeco_SetResync(NexRvDeco *d, int on)
+{
+  d->resync = on;
+}
+
+void NexRvDeco_SetSeqJump(NexRvDeco *d, int on)
+{
+  d->seqJump = on;
+}
+
+void NexRvDeco_SetMsbExt(NexRvDeco *d, int on)
+{
+  d->msbExt = on;
+}
+
+int NexRvDeco_SetCallStack(NexRvDeco *d, int depth)
+{
+  if (depth <= 0 || depth > CALLSTACK_MAX) return -1;
+  return CallStack_Init(&d->callStack, depth);
+}
+
+uint64_t NexRvDeco_LostBytes(const NexRvDeco *d)
+{
+  return d->lostBytes;
+}
+
+// Time (cycles) of last message with TSTAMP - instructions reported by
+// callback were retired till then. Returns 0 if time is not known.
+int NexRvDeco_Time(const NexRvDeco *d, uint64_t *pTime)
+{
+  if (!d->timeValid) return 0;
+  *pTime = d->time;
+  return 1;
+}
+
+void NexRvDeco_Destroy(NexRvDeco *d)
+{
+  DecoTerm(d);
+  free(d);
+}
 
-      msgFields[msgFieldCnt++] = fldVal & ((((Nexus_TypeField)1) << fldSize) - 1); // Save field
+#endif
+
+#if !NEXRV_LIB
+
+// Decode file (from current position till end of it or till stop).
+// Returns 0 or error (number of instructions is in 'd->nInstr').
+static int NexusDecoFile(NexRvDeco *d, NexRvFile *nf, int disp)
+{
+  d->bytePos = NEXRV_FILE_POS(nf);
 
-      if (disp & 1) printf(" %s[%d]=0x%lX", nexusMsgDef[fldDef].name, fldSize, fldVal & ((((Nexus_TypeField)1) << fldSize) - 1));
-      fldDef++;
-      fldVal >>= fldSize;
-      fldBits -= fldSize;
+  unsigned char msgByte;
+  while (NEXRV_FILE_GET(nf, msgByte))
+  {
+    int ret = DecoByte(d, msgByte, disp);
+    if (ret < 0) ret = DecoResync(d, ret);
+    if (ret < 0) return ret;
+    if (ret > 0) break;
+    if (msgByte == 0xFF)
+    {
+      // Following idles (in current block) are skipped in bulk
+      size_t n = NexRvScan_Idle(nf->pCur, (size_t)(nf->pEnd - nf->pCur));
+      nf->pCur   += n;
+      d->bytePos += n;
     }
+  }
+
+  if (d->waitSync) DecoResyncEnd(d, d->bytePos, disp);
 
-    if (mseo == 0x0)
+  if (d->lastMsg)
+  {
+    // Last message is counted by next segment
+    d->msgCnt   = d->lastCnt;
+    d->msgBytes = d->lastBytes;
+    d->nHW      = d->lastHW;
+  }
+
+  return 0;
+}
+
+static void DecoStat(NexRvDeco *d, int disp)
+{
+  if (disp & 4)
+  {
+    printf("Stat: %d bytes, %d messages, %d error messages", d->msgBytes, d->msgCnt, d->msgErrors);
+    if (d->msgCnt > 0) printf(", %.2lf bytes/message", ((double)d->msgBytes) / d->msgCnt);
+    if (d->nInstr > 0) printf(", %lu instr, %.3lf bits/instr", d->nInstr, ((double)d->msgBytes * 8) / d->nInstr);
+    printf("\n");
+    if (d->hc != NULL) printf("NexRv/HistCache: %lu hits, %lu misses\n", d->hc->hits, d->hc->misses);
+    if (d->tcodeCnt[NEXUS_TCODE_Ownership] > 0) printf("NexRv/Process: %d Ownership messages, %d images\n", d->tcodeCnt[NEXUS_TCODE_Ownership], InfoProcessCount());
+    if (d->nTstamp > 0)
     {
-      if (disp & 1) printf("\n");
-      continue;
+      uint64_t cycles = d->time - d->timeFirst;
+      printf("NexRv/Time: %lu timestamps, %lu cycles (0x%lX..0x%lX)", d->nTstamp, cycles, d->timeFirst, d->time);
+      if (cycles > 0) printf(", %.3lf IPC", ((double)d->nInstr) / cycles);
+      printf("\n");
+    }
+    if (d->resync)
+    {
+      printf("NexRv/Resync: %d gaps, %lu bytes lost, %lu ICNT units lost", d->nGaps, d->lostBytes, d->lostHW);
+      if (d->nInstr > 0 && d->nHW > d->lostHW)
+      {
+        // Estimate by average size of decoded instructions
+        printf(" (~%.0lf instr)", ((double)d->lostHW * d->nInstr) / (d->nHW - d->lostHW));
+      }
+      printf("\n");
     }
+  }
+}
+
+// Add statistics of 'd' (segment or hart) to 'sum'
+static void DecoAdd(NexRvDeco *sum, const NexRvDeco *d)
+{
+  sum->nInstr    += d->nInstr;
+  sum->msgCnt    += d->msgCnt;
+  sum->msgBytes  += d->msgBytes;
+  sum->msgErrors += d->msgErrors;
+  sum->nHW       += d->nHW;
+  sum->nGaps     += d->nGaps;
+  sum->lostBytes += d->lostBytes;
+  sum->lostHW    += d->lostHW;
+
+  if (sum->fold != NULL && d->fold != NULL) DecoFoldMerge(sum->fold, 0, d->fold, 0);
+  if (sum->cov != NULL && d->cov != NULL) Cov_Merge(sum->cov, d->cov);
+
+  if (d->nTstamp > 0)
+  {
+    // Time of whole trace (or of all harts)
+    if (sum->nTstamp == 0 || d->timeFirst < sum->timeFirst) sum->timeFirst = d->timeFirst;
+    if (sum->nTstamp == 0 || d->time > sum->time) sum->time = d->time;
+    sum->nTstamp += d->nTstamp;
+  }
 
-    if (nexusMsgDef[fldDef].def & 0x400)
+  if (sum->prof != NULL && d->prof != NULL)
+  {
+    for (int i = 0; i <= InfoRecCount(); i++)
     {
-      // Variable size field
-      if (disp & 1) printf(" %s[%d]=0x%lX\n", nexusMsgDef[fldDef].name, fldBits, fldVal);
+      sum->prof[i] += d->prof[i];
+    }
+  }
+}
 
-      msgFields[msgFieldCnt++] = fldVal; // Save field
+#if 1 // Profile file (-profile option)
 
-      if (mseo == 3)
-      {
-        int cnt = 1;
+typedef struct DECO_PROF
+{
+  uint64_t        instr;    // Executed instructions (of function or block)
+  uint64_t        count;    // Executions of first instruction (entries of function or block)
+  Nexus_TypeAddr  addr;
+  int             size;     // Number of instructions of block
+  int             sym;      // Symbol (function) index, or -1
+} DECO_PROF;
+
+static int DecoProfCompare(const void *p1, const void *p2)
+{
+  const DECO_PROF *e1 = (const DECO_PROF *)p1;
+  const DECO_PROF *e2 = (const DECO_PROF *)p2;
+  if (e1->instr != e2->instr) return (e1->instr > e2->instr) ? -1 : 1;   // Most executed first
+  return (e1->addr < e2->addr) ? -1 : (e1->addr > e2->addr) ? 1 : 0;
+}
 
-        dispHistRepeat = 0; 
+static const char *DecoProfName(int sym)
+{
+  return (sym >= 0) ? InfoSymGet(sym, NULL) : "?";
+}
 
-        if (msgFields[0] == NEXUS_TCODE_RepeatBranch)
-        {
-          // Special handling for repeat branch (which only has 1 field!)
-          cnt = msgFields[1]; // Counter set in RepeatBranch message
-          msgFieldPos = savedFields[0]; // Restrore previous message (saved)
-          msgFieldCnt = savedFields[1];
-          msgFields[0] = savedFields[2];
-          msgFields[1] = savedFields[3];
-          msgFields[2] = savedFields[4];
-          msgFields[3] = savedFields[5];
-          msgFields[4] = savedFields[6];
-          dispHistRepeat = cnt;
-        }
+// Write flat profile (functions and basic-blocks sorted by executed instructions).
+// Block starts at target of direct jump/branch, after control-flow instruction,
+// after gap in addresses and at symbol.
+static int DecoProfWrite(FILE *f, const int64_t *prof, int disp)
+{
+  int nRec = InfoRecCount();
+  int nSym = InfoSymCount();
+  uint64_t *cnt = (uint64_t *)malloc((nRec + 1) * sizeof(uint64_t));
+  unsigned char *lead = (unsigned char *)calloc(nRec + 1, 1);
+  DECO_PROF *fn  = (DECO_PROF *)calloc(nSym + 1, sizeof(DECO_PROF));   // Last one is for code without symbol
+  DECO_PROF *blk = (DECO_PROF *)calloc(nRec + 1, sizeof(DECO_PROF));
+  if (cnt == NULL || lead == NULL || fn == NULL || blk == NULL)
+  {
+    free(cnt); free(lead); free(fn); free(blk);
+    return EmitErrorMsg("Not enough memory");
+  }
 
-        while (cnt > 0) // Handle (1 or many times ...)
-        {
-          int err = MsgHandle(f, disp);
-          if (err < 0) return err;
-          cnt--;
-        }
+  // Counts of instructions (sum of differences) and starts of blocks
+  int64_t c = 0;
+  uint64_t total = 0;
+  for (int i = 0; i < nRec; i++)
+  {
+    c += prof[i];
+    cnt[i] = (uint64_t)c;
+    total += cnt[i];
+
+    InfoAddr a, dest;
+    unsigned int info = InfoRecGet(i, &a);
+    const InfoImage *img = InfoRecImage(i);
+    if ((info & (INFO_BRANCH | INFO_JUMP)) && (!(info & INFO_INDIRECT) || (info & INFO_SEQJUMP)))
+    {
+      InfoGet(img, a, &dest);
+      int t = InfoRecFind(img, dest);
+      if (t >= 0) lead[t] = 1;
+    }
+    if (i + 1 < nRec)
+    {
+      InfoAddr next;
+      InfoRecGet(i + 1, &next);
+      if ((info & ~(INFO_LINEAR | INFO_4)) || next != a + ((info & INFO_4) ? 4 : 2) || InfoRecImage(i + 1) != img) lead[i + 1] = 1;
+    }
+  }
+  lead[0] = 1;
 
-        fldDef = -1;
-      }
-      else
+  for (int k = 0; k <= nSym; k++)
+  {
+    fn[k].sym = (k < nSym) ? k : -1;
+    if (k < nSym)
+    {
+      InfoSymGet(k, &fn[k].addr);
+      int r = InfoRecFind(InfoSymImage(k), fn[k].addr);
+      if (r >= 0)
       {
-        fldDef++;
+        fn[k].count = cnt[r];
+        lead[r] = 1;
       }
-      fldBits = 0;
-      fldVal = 0;
-      continue;
     }
+  }
+
+  // Sum instructions by functions and by blocks
+  int nBlk = 0;
+  for (int i = 0; i < nRec; i++)
+  {
+    InfoAddr a;
+    InfoRecGet(i, &a);
+    int sym = InfoSymFind(InfoRecImage(i), a);
+    fn[(sym >= 0) ? sym : nSym].instr += cnt[i];
+
+    if (lead[i])
+    {
+      if (nBlk > 0 && blk[nBlk - 1].instr == 0) nBlk--;   // Keep executed blocks only
+      blk[nBlk].addr  = a;
+      blk[nBlk].count = cnt[i];
+      blk[nBlk].instr = 0;
+      blk[nBlk].size  = 0;
+      blk[nBlk].sym   = sym;
+      nBlk++;
+    }
+    blk[nBlk - 1].instr += cnt[i];
+    blk[nBlk - 1].size++;
+  }
+  if (nBlk > 0 && blk[nBlk - 1].instr == 0) nBlk--;
+
+  qsort(fn, nSym + 1, sizeof(DECO_PROF), DecoProfCompare);
+  qsort(blk, nBlk, sizeof(DECO_PROF), DecoProfCompare);
+
+  int nFn = 0;
+  while (nFn <= nSym && fn[nFn].instr > 0) nFn++;
+
+  fprintf(f, ". NexRv profile: %lu instructions, %d functions, %d blocks\n", total, nFn, nBlk);
+  fprintf(f, ". Functions: <instr>,<percent>,<entries>,<addr>,<name>\n");
+  for (int k = 0; k < nFn; k++)
+  {
+    fprintf(f, "%lu,%.2lf,%lu,0x%lX,%s\n", fn[k].instr, (100.0 * fn[k].instr) / total, fn[k].count, fn[k].addr, DecoProfName(fn[k].sym));
+  }
+  fprintf(f, ". Blocks: <instr>,<percent>,<count>,<addr>,<size>,<function>\n");
+  for (int k = 0; k < nBlk; k++)
+  {
+    fprintf(f, "%lu,%.2lf,%lu,0x%lX,%d,%s\n", blk[k].instr, (100.0 * blk[k].instr) / total, blk[k].count, blk[k].addr, blk[k].size, DecoProfName(blk[k].sym));
+  }
+
+  if (disp & 4) printf("NexRv/Profile: %lu instructions, %d functions, %d blocks\n", total, nFn, nBlk);
+
+  free(cnt); free(lead); free(fn); free(blk);
+  return 0;
+}
+
+#endif
+
+#if 1 // Folded-stack file (-folded option)
+
+// Write one line for each path of call-tree with executed instructions
+// ("main;foo;bar <instr>"), which is input of flame-graph tools.
+static int DecoFoldWrite(FILE *f, const DECO_FOLD *fo, int disp)
+{
+  int path[DECO_FOLD_DEPTH + 1];
+  int nLines   = 0;
+  int maxDepth = 0;
+  for (int k = 1; k < fo->nNodes; k++)
+  {
+    if (fo->n[k].instr == 0) continue;
 
-    if (fldBits > 0)
+    int n = 0;
+    for (int p = k; p > 0; p = fo->n[p].parent) path[n++] = p;
+    for (int i = n - 1; i >= 0; i--)
     {
-      printf(" ERROR: Not enough bits for non-variable field\n");
-      return -4;
+      int sym = fo->n[path[i]].sym;
+      fprintf(f, "%s%s", (sym >= 0) ? InfoSymGet(sym, NULL) : "[unknown]", (i > 0) ? ";" : "");
     }
+    fprintf(f, " %lu\n", fo->n[k].instr);
+
+    nLines++;
+    if (n > maxDepth) maxDepth = n;
+  }
+
+  if (disp & 4) printf("NexRv/Folded: %d stacks, max depth %d\n", nLines, maxDepth);
+  return 0;
+}
+
+#endif
+
+#if 1 // IPC report (-ipc option)
+
+typedef struct DECO_IPCFN
+{
+  double    cycles;
+  uint64_t  instr;
+  int       fn;       // Function (symbol index, or InfoSymCount() for code without symbol)
+} DECO_IPCFN;
+
+static int DecoIpcCompare(const void *p1, const void *p2)
+{
+  const DECO_IPCFN *e1 = (const DECO_IPCFN *)p1;
+  const DECO_IPCFN *e2 = (const DECO_IPCFN *)p2;
+  if (e1->cycles != e2->cycles) return (e1->cycles > e2->cycles) ? -1 : 1;   // Most cycles first
+  return e1->fn - e2->fn;
+}
+
+// End of trace: write last window and functions (sorted by cycles).
+// Instructions after last TSTAMP have no time.
+static int DecoIpcWrite(DECO_IPC *ip, int disp)
+{
+  FILE *f = ip->f;
+  DecoIpcLost(ip);
+  DecoIpcWinEnd(ip);
+
+  DECO_IPCFN *fn = (DECO_IPCFN *)malloc(ip->nFn * sizeof(DECO_IPCFN));
+  if (fn == NULL) return EmitErrorMsg("Not enough memory");
+  int n = 0;
+  for (int k = 0; k < ip->nFn; k++)
+  {
+    if (ip->fnCycles[k] <= 0 && ip->fnInstr[k] == 0) continue;
+    fn[n].cycles = ip->fnCycles[k];
+    fn[n].instr  = ip->fnInstr[k];
+    fn[n].fn     = k;
+    n++;
+  }
+  qsort(fn, n, sizeof(DECO_IPCFN), DecoIpcCompare);
+
+  double ipc = (ip->cycles > 0) ? ((double)ip->instr) / ip->cycles : 0.0;
+  fprintf(f, ". Functions: <cycles>,<percent>,<instr>,<IPC>,<addr>,<name>\n");
+  for (int k = 0; k < n; k++)
+  {
+    InfoAddr a = 0;
+    const char *name = "?";
+    if (fn[k].fn < ip->nFn - 1) name = InfoSymGet(fn[k].fn, &a);
+    fprintf(f, "%.0lf,%.2lf,%lu,%.3lf,0x%lX,%s\n", fn[k].cycles,
+            (ip->cycles > 0) ? (100.0 * fn[k].cycles) / ip->cycles : 0.0, fn[k].instr,
+            (fn[k].cycles > 0) ? fn[k].instr / fn[k].cycles : 0.0, a, name);
   }
+  fprintf(f, ". NexRv IPC: %lu cycles, %lu instructions, %.3lf IPC, %d windows of %lu cycles, %lu instructions without time\n",
+          ip->cycles, ip->instr, ipc, ip->nWin, ip->window, ip->noTime);
 
   if (disp & 4)
   {
-    printf("Stat: %d bytes, %d messages, %d error messages", msgBytes, msgCnt, msgErrors);
-    if (msgCnt > 0) printf(", %.2lf bytes/message", ((double)msgBytes) / msgCnt);
-    if (nInstr > 0) printf(", %d instr, %.3lf bits/instr", nInstr, ((double)msgBytes * 8) / nInstr);
+    printf("NexRv/IPC: %lu cycles, %lu instructions, %.3lf IPC, %d windows, %d functions", ip->cycles, ip->instr, ipc, ip->nWin, n);
+    if (ip->noTime > 0) printf(", %lu instructions without time", ip->noTime);
     printf("\n");
   }
 
-  return nInstr; // Number of instructions generated
+  free(fn);
+  return 0;
 }
 
+#endif
+
+#if 1 // Statistics only (-stat-fast option)
+
+// Decode for statistics only (no PCOUT). Without PCINFO only fields are
+// counted (sum of ICNT is exact number of 16-bit units). With PCINFO of
+// 32-bit instructions only, number of instructions is half of units. Other
+// PCINFO falls back to walk of basic-blocks (ICNT and HIST by block table
+// and HIST cache, no PCs are written) to count instructions exactly.
+// Returns 1 if '*pCount' is instructions, 0 if it is units.
+int NexusDecoFast(int withInfo, int disp, uint64_t *pCount)
+{
+  NexRvFile nf;
+  if (NexRvFile_Open(&nf, fNex) < 0) return EmitErrorMsg("Cannot read NEX file");
+
+  NexusMsgInit();   // TCODE look-up table
+
+  int only4 = withInfo && InfoRecCount() > 0;
+  for (int r = 0; only4 && r < InfoRecCount(); r++)
+  {
+    InfoAddr a;
+    if (!(InfoRecGet(r, &a) & INFO_4)) only4 = 0;
+  }
+
+  NexRvDeco d;
+  DecoInit(&d, NULL, NULL, CALLSTACK_DEFAULT);
+  d.statFast = (withInfo && !only4) ? 2 : 1;
+
+  double t = NexRvFile_Seconds();
+  int ret = NexusDecoFile(&d, &nf, 0);
+  t = NexRvFile_Seconds() - t;
+
+  if (ret >= 0 && (disp & 4))
+  {
+    DecoStat(&d, disp);
+    printf("Fast: %lu ICNT units (halfwords), %lu HIST branches", d.nHW, d.nBranch);
+    if (d.nHW > 0) printf(", %.3lf bits/unit", ((double)d.msgBytes * 8) / d.nHW);
+    if (only4 && d.nHW > 0) printf(", %lu instr, %.3lf bits/instr", d.nHW / 2, ((double)d.msgBytes * 16) / d.nHW);
+    printf("\n");
+    if (d.statFast == 2) printf("Fast: PCINFO has 16-bit instructions, instructions are counted by basic-blocks\n");
+
+    printf("Msg:");
+    for (int k = 0; k < (1 << NEXUS_FLDSIZE_TCODE); k++)
+    {
+      if (d.tcodeCnt[k] > 0) printf(" %s=%d", nexusMsgDef[nexusMsgTcode[k]].name, d.tcodeCnt[k]);
+    }
+    printf("\n");
+
+    double mb = ((double)NEXRV_FILE_POS(&nf)) / (1024 * 1024);
+    printf("Speed: %.2lf MB in %.3lf sec", mb, t);
+    if (t > 0) printf(", %.2lf MB/s", mb / t);
+    printf("\n");
+  }
+
+  DecoTerm(&d);
+  NexRvFile_Close(&nf);
+  if (ret < 0) return ret;
+  if (d.statFast == 2) *pCount = d.nInstr;
+  else                 *pCount = only4 ? d.nHW / 2 : d.nHW;
+  return withInfo;
+}
+
+#endif
+
+#if 1 // Parallel decoding (-j option)
+
+#define DECO_SEG_MAX  256   // Max number of segments (and threads)
+
+typedef struct DECO_SEG
+{
+  NexRvDeco   d;      // Decoder state (independent for each segment)
+  NexRvFile   nf;     // View of mapped Nexus file (starting at segment)
+  NexRvPcBin  pb;     // Binary PCOUT writer of this segment
+  FILE        *f;     // Output of this segment (temporary file, except first segment)
+  int         disp;
+  int         ret;
+} DECO_SEG;
+
+// Fast pre-scan (no decoding) to find offsets of (up to 'nSeg') segments.
+// First segment starts at 0, other segments start at first synchronizing message
+// after 'k * size / nSeg' offset. Message starts after byte with MSEO='11'
+// (it is end of message or idle), so no message must be parsed.
+static int DecoSplit(const unsigned char *p, uint64_t size, int nSeg, uint64_t *segPos)
+{
+  int n = 0;
+  segPos[n++] = 0;
+
+  for (int k = 1; k < nSeg; k++)
+  {
+    uint64_t i = (size / nSeg) * k;
+    if (i <= segPos[n - 1]) i = segPos[n - 1] + 1;
+
+    while (i < size)
+    {
+      i += NexRvScan_End(p + i, (size_t)(size - i));  // Skip inside of a message
+      if (i >= size) break;
+      i++;
+      if (i < size && (p[i] & 0x3) == 0 && IsSyncTcode(p[i] >> 2)) break;
+    }
+    if (i >= size) break; // No more sync messages
+
+    segPos[n++] = i;
+  }
+  return n;
+}
+
+// Process (PROCESS of last Ownership message) at start of each segment (for
+// -process). Only first bytes of messages are checked (TCODE with MSEO='00'),
+// so it is a scan of message ends as well. Trace has no SRC field here.
+static void DecoSplitProcess(const unsigned char *p, uint64_t size, int nSeg, const uint64_t *segPos, DECO_SEG *seg)
+{
+  uint64_t process = 0;
+  int valid = 0;
+  uint64_t i = 0;
+  for (int k = 0; k < nSeg; k++)
+  {
+    while (i < segPos[k])
+    {
+      if (p[i] == (NEXUS_TCODE_Ownership << 2))
+      {
+        // PROCESS (variable field) follows TCODE
+        uint64_t v = 0;
+        int nb = 0;
+        for (uint64_t j = i + 1; j < size && nb < 64; j++, nb += 6)
+        {
+          v |= (uint64_t)(p[j] >> 2) << nb;
+          if (p[j] & 0x3) break;
+        }
+        process = v;
+        valid   = 1;
+      }
+      i += NexRvScan_End(p + i, (size_t)(size - i)) + 1;
+    }
+    seg[k].d.process      = process;
+    seg[k].d.processValid = valid;
+    seg[k].d.img          = valid ? InfoProcessImage(process) : NULL;
+  }
+}
+
+static void *DecoSegRun(void *p)
+{
+  DECO_SEG *seg = (DECO_SEG *)p;
+  seg->ret = NexusDecoFile(&seg->d, &seg->nf, seg->disp);
+  return NULL;
+}
+
+// Append output of segment to final output (binary PCs are re-encoded)
+static int DecoSegAppend(DECO_SEG *seg, FILE *f, NexRvPcBin *pcBin)
+{
+  rewind(seg->f);
+  if (pcBin != NULL)
+  {
+    NexRvPcBin rd;
+    Nexus_TypeAddr pc;
+    int ret;
+    if (PcBin_ReadOpen(&rd, seg->f) != 1) return -1;
+    while ((ret = PcBin_Get(&rd, &pc)) > 0)
+    {
+      if (PcBin_Put(pcBin, pc) < 0) return -1;
+    }
+    return ret;
+  }
+
+  char buf[0x4000];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), seg->f)) > 0)
+  {
+    if (fwrite(buf, 1, n, f) != n) return -1;
+  }
+  return 0;
+}
+
+// Split trace at sync messages and decode all segments in parallel.
+// Each segment decodes past its end till the end of first message of next
+// segment (this sync message will provide ICNT of last instructions).
+// Outputs of segments are appended (in order) to 'f' (or 'pcBin').
+static int NexusDecoParallel(NexRvFile *nf, FILE *f, NexRvPcBin *pcBin, int disp, NexRvDeco *sum, int *pSeg)
+{
+  uint64_t segPos[DECO_SEG_MAX];
+  int nSeg = (conf_Jobs < DECO_SEG_MAX) ? conf_Jobs : DECO_SEG_MAX;
+  nSeg = DecoSplit(nf->pBlock, nf->mapSize, nSeg, segPos);
+  *pSeg = nSeg;
+
+  DECO_SEG *seg = (DECO_SEG *)malloc(nSeg * sizeof(DECO_SEG));
+  if (seg == NULL) return EmitErrorMsg("Not enough memory");
+
+  int ret = 0;
+  int nOpen = 0;
+  for (int k = 0; k < nSeg; k++)
+  {
+    DECO_SEG *s = &seg[k];
+    s->disp = disp & 0x10;  // Only annotation of PCOUT (threads print nothing)
+    s->ret  = 0;
+    s->f    = f;
+    NexRvPcBin *pb = pcBin;
+    if (k > 0 && (f != NULL || pcBin != NULL))   // No PCOUT with -profile/-coverage
+    {
+      s->f = tmpfile();
+      if (s->f == NULL)
+      {
+        ret = EmitErrorMsg("Cannot create temporary file");
+        break;
+      }
+      if (pcBin != NULL)
+      {
+        PcBin_WriteOpen(&s->pb, s->f);
+        pb = &s->pb;
+      }
+    }
+    nOpen++;
+
+    DecoInit(&s->d, (pcBin != NULL) ? NULL : s->f, pb, conf_CallStack);
+    s->d.resync = conf_Resync;
+    if ((conf_Profile != NULL && DecoProfInit(&s->d) < 0) || (conf_Coverage != NULL && DecoCovInit(&s->d) < 0))
+    {
+      ret = EmitErrorMsg("Not enough memory");
+      break;
+    }
+    if (k + 1 < nSeg) s->d.endPos = segPos[k + 1];
+    NexRvFile_View(&s->nf, nf, segPos[k]);
+  }
+  if (ret == 0 && InfoProcessCount() > 0) DecoSplitProcess(nf->pBlock, nf->mapSize, nSeg, segPos, seg);
+
+  if (ret == 0)
+  {
+#if NEXRV_THREADS
+    pthread_t th[DECO_SEG_MAX];
+    int started[DECO_SEG_MAX];
+    for (int k = 1; k < nSeg; k++)
+    {
+      started[k] = (pthread_create(&th[k], NULL, DecoSegRun, &seg[k]) == 0);
+    }
+    DecoSegRun(&seg[0]);
+    for (int k = 1; k < nSeg; k++)
+    {
+      if (started[k]) pthread_join(th[k], NULL);
+      else            DecoSegRun(&seg[k]);  // Thread was not created - do it here
+    }
+#else
+    for (int k = 0; k < nSeg; k++)
+    {
+      DecoSegRun(&seg[k]);
+    }
+#endif
+
+    for (int k = 0; k < nSeg; k++)
+    {
+      if (seg[k].ret < 0)
+      {
+        ret = seg[k].ret;   // First error (in trace order) is reported
+        break;
+      }
+      if (k > 0 && seg[k].f != NULL)
+      {
+        if (pcBin != NULL && PcBin_WriteClose(&seg[k].pb) < 0) ret = -1;
+        if (ret == 0 && DecoSegAppend(&seg[k], f, pcBin) < 0) ret = -1;
+        if (ret < 0)
+        {
+          ret = EmitErrorMsg("Cannot append segment to PCOUT file");
+          break;
+        }
+      }
+      DecoAdd(sum, &seg[k].d);
+    }
+  }
+
+  for (int k = 0; k < nOpen; k++)
+  {
+    DecoTerm(&seg[k].d);
+    if (k > 0 && seg[k].f != NULL) fclose(seg[k].f);
+  }
+  free(seg);
+
+  return ret;
+}
+
+#endif
+
+#if 1 // Index of sync messages (-index) and decoding of a window (-from/-offset/-count)
+
+// Find last sync message (in index file) before instruction 'from' or before file offset 'pos'.
+// Index lines are '<offset>,<instr>,<faddr>[,<process>]' (in file order), process is there
+// after first Ownership message. Lines starting with '.' are comments.
+static int DecoIndexFind(FILE *fIdx, uint64_t from, uint64_t pos, uint64_t *pPos, uint64_t *pInstr, NexRvDeco *d)
+{
+  int found = 0;
+  char line[200];
+  while (fgets(line, sizeof(line), fIdx) != NULL)
+  {
+    if (line[0] == '.') continue; // Comment
+
+    unsigned long o, n, a, p;
+    int k = sscanf(line, "0x%lX,%lu,0x%lX,0x%lX", &o, &n, &a, &p);
+    if (k < 3) return -1;
+    if (n > from || o > pos) break;
+
+    *pPos   = o;
+    *pInstr = n;
+    d->process      = (k == 4) ? p : 0;
+    d->processValid = (k == 4);
+    d->img          = (k == 4) ? InfoProcessImage(p) : NULL;
+    found++;
+  }
+  return found;
+}
+
+// Create index file (sync message offsets with instruction counts and addresses)
+int NexusIndex(FILE *fIdx, int disp, uint64_t *pInstr)
+{
+  NexRvFile nf;
+  if (NexRvFile_Open(&nf, fNex) < 0) return EmitErrorMsg("Cannot read NEX file");
+
+  if (conf_CallStack < 0)
+  {
+    conf_CallStack = -conf_CallStack;
+  }
+  NexusMsgInit();   // TCODE look-up table
+
+  fprintf(fIdx, ". NexRv index: <offset>,<instr>,<faddr>[,<process>] of each sync message\n");
+
+  NexRvDeco d;
+  DecoInit(&d, NULL, NULL, conf_CallStack);   // No PCOUT, just count instructions
+  d.fIdx = fIdx;
+
+  int ret = NexusDecoFile(&d, &nf, disp);
+  if (ret >= 0) DecoStat(&d, disp);
+  *pInstr = d.nInstr;
+
+  DecoTerm(&d);
+  NexRvFile_Close(&nf);
+  return ret;
+}
+
+#endif
+
+#if 1 // Multi-hart decoding (-src-bits option)
+
+#define DECO_SRC_MAX    (1 << NEXUS_SRC_BITS_MAX)
+#define DECO_MSG_MAX    256       // Max size of one message (it is stored before SRC is known)
+#define DECO_SRC_CHUNK  0x400000  // Demultiplexed bytes decoded at once (memory does not depend on trace size)
+
+typedef struct DECO_SRC
+{
+  NexRvDeco     d;      // Decoder state of this hart (own call-stack, last address, ...)
+  NexRvPcBin    pb;     // Binary PCOUT writer of this hart
+  FILE          *f;     // PCOUT file of this hart
+  unsigned char *p;     // Messages of this hart (demultiplexed, not decoded yet)
+  size_t        size;
+  size_t        cap;
+  int           src;
+  int           ret;
+} DECO_SRC;
+
+typedef struct DECO_POOL
+{
+  DECO_SRC      **src;  // Harts to be decoded
+  int           n;
+  int           next;   // Next hart to be taken by a worker
+  int           disp;
+#if NEXRV_THREADS
+  pthread_mutex_t lock;
+#endif
+} DECO_POOL;
+
+// Append one message to buffer of its hart
+static int DecoSrcPut(DECO_SRC *s, const unsigned char *msg, int len)
+{
+  if (s->size + len > s->cap)
+  {
+    size_t cap = (s->cap == 0) ? 0x10000 : 2 * s->cap;
+    unsigned char *p = (unsigned char *)realloc(s->p, cap);
+    if (p == NULL) return -1;
+    s->p   = p;
+    s->cap = cap;
+  }
+  memcpy(s->p + s->size, msg, len);
+  s->size += len;
+  return 0;
+}
+
+// Worker of thread pool (takes next hart till buffers of all harts are decoded)
+static void *DecoSrcWorker(void *p)
+{
+  DECO_POOL *pool = (DECO_POOL *)p;
+  for (;;)
+  {
+#if NEXRV_THREADS
+    pthread_mutex_lock(&pool->lock);
+#endif
+    int k = pool->next++;
+#if NEXRV_THREADS
+    pthread_mutex_unlock(&pool->lock);
+#endif
+    if (k >= pool->n) break;
+
+    DECO_SRC *s = pool->src[k];
+    for (size_t i = 0; i < s->size && s->ret >= 0; i++)
+    {
+      int ret = DecoByte(&s->d, s->p[i], pool->disp);
+      if (ret < 0) s->ret = DecoResync(&s->d, ret);
+    }
+    s->size = 0;  // Decoder state continues with next chunk
+  }
+  return NULL;
+}
+
+// Decode buffered messages of all harts by pool of 'conf_Jobs' threads.
+// Returns error of first hart (in SRC order), which failed so far.
+static int DecoSrcRun(DECO_POOL *pool, DECO_SRC **src)
+{
+  int nThreads = (conf_Jobs < pool->n) ? conf_Jobs : pool->n;
+  pool->next = 0;
+#if NEXRV_THREADS
+  pthread_t th[DECO_SRC_MAX];
+  int started[DECO_SRC_MAX];
+  for (int k = 1; k < nThreads; k++)
+  {
+    started[k] = (pthread_create(&th[k], NULL, DecoSrcWorker, pool) == 0);
+  }
+  DecoSrcWorker(pool);  // This thread is one of workers
+  for (int k = 1; k < nThreads; k++)
+  {
+    if (started[k]) pthread_join(th[k], NULL);
+  }
+#else
+  (void)nThreads;
+  DecoSrcWorker(pool);
+#endif
+
+  for (int k = 0; k < DECO_SRC_MAX; k++)
+  {
+    if (src[k] != NULL && src[k]->ret < 0) return src[k]->ret;
+  }
+  return 0;
+}
+
+// PCOUT file of hart is <name>-<src> (SRC is inserted before extension)
+static const char *DecoSrcName(char *buf, size_t size, const char *name, int src)
+{
+  const char *ext = strrchr(name, '.');
+  if (ext == NULL || strchr(ext, '/') != NULL || strchr(ext, '\\') != NULL) ext = name + strlen(name);
+  snprintf(buf, size, "%.*s-%d%s", (int)(ext - name), name, src, ext);
+  return buf;
+}
+
+// Create decoder state and PCOUT file of hart (at its first message)
+static int DecoSrcInit(DECO_SRC *s)
+{
+  char name[1024];
+  if (conf_PcOut == NULL)
+  {
+    DecoInit(&s->d, NULL, NULL, conf_CallStack);  // No PCOUT (-profile/-folded/-coverage)
+  }
+  else
+  if ((s->f = fopen(DecoSrcName(name, sizeof(name), conf_PcOut, s->src), conf_PcBin ? "wb" : "wt")) == NULL)
+  {
+    return EmitErrorMsg("Cannot create PCOUT file");
+  }
+  else
+  if (conf_PcBin)
+  {
+    PcBin_WriteOpen(&s->pb, s->f);
+    DecoInit(&s->d, NULL, &s->pb, conf_CallStack);
+  }
+  else
+  {
+    DecoInit(&s->d, s->f, NULL, conf_CallStack);
+  }
+  s->d.srcBits = conf_nSrc;
+  s->d.resync  = conf_Resync;
+  if ((conf_Profile != NULL && DecoProfInit(&s->d) < 0) || (conf_Folded != NULL && DecoFoldInit(&s->d) < 0) ||
+      (conf_Coverage != NULL && DecoCovInit(&s->d) < 0))
+  {
+    return EmitErrorMsg("Not enough memory");
+  }
+  return 0;
+}
+
+// Demultiplex messages by SRC field (it follows TCODE) to per-hart buffers
+// and decode all harts by pool of 'conf_Jobs' threads. Each hart has its own
+// decoder state and PCOUT file. Trace is demultiplexed in chunks (buffers of
+// harts are decoded, when DECO_SRC_CHUNK bytes are in them), so memory does
+// not depend on trace size. Statistics are summed to 'sum'.
+static int NexusDecoSrc(NexRvFile *nf, int disp, NexRvDeco *sum, int *pSrc)
+{
+  DECO_SRC *src[DECO_SRC_MAX];
+  memset(src, 0, sizeof(src));
+
+  DECO_POOL pool;
+  DECO_SRC *list[DECO_SRC_MAX];
+  pool.src  = list;
+  pool.n    = 0;
+  pool.disp = disp & 0x10;  // Only annotation of PCOUT (threads print nothing)
+#if NEXRV_THREADS
+  pthread_mutex_init(&pool.lock, NULL);
+#endif
+
+  unsigned char msg[DECO_MSG_MAX];
+  int len = 0;
+  int ret = 0;
+  size_t nBuf = 0;  // Bytes in buffers of harts
+  unsigned char b;
+  while (ret == 0 && NEXRV_FILE_GET(nf, b))
+  {
+    if (len == 0 && (b & 0x3) == 0x3)
+    {
+      // Idle (following idles in current block are skipped in bulk)
+      nf->pCur += NexRvScan_Idle(nf->pCur, (size_t)(nf->pEnd - nf->pCur));
+      continue;
+    }
+    if (len >= DECO_MSG_MAX)
+    {
+      ret = EmitErrorMsg("Message is too long");
+      break;
+    }
+    msg[len++] = b;
+    if ((b & 0x3) != 0x3) continue;
+
+    // Message is complete - take SRC (first bits after TCODE)
+    unsigned int v = 0;
+    int nb = 0;
+    for (int i = 1; i < len && nb < conf_nSrc; i++, nb += 6)
+    {
+      v |= (unsigned int)(msg[i] >> 2) << nb;
+    }
+    if (nb < conf_nSrc)
+    {
+      ret = EmitErrorMsg("Message without SRC field");
+      break;
+    }
+    v &= (1u << conf_nSrc) - 1;
+
+    if (src[v] == NULL)
+    {
+      src[v] = (DECO_SRC *)calloc(1, sizeof(DECO_SRC));
+      if (src[v] == NULL)
+      {
+        ret = EmitErrorMsg("Not enough memory");
+        break;
+      }
+      src[v]->src = v;
+      list[pool.n++] = src[v];
+      ret = DecoSrcInit(src[v]);
+      if (ret < 0) break;
+    }
+    if (DecoSrcPut(src[v], msg, len) < 0) ret = EmitErrorMsg("Not enough memory");
+    nBuf += len;
+    len = 0;
+
+    if (ret == 0 && nBuf >= DECO_SRC_CHUNK)
+    {
+      ret = DecoSrcRun(&pool, src);
+      nBuf = 0;
+    }
+  }
+  if (ret == 0) ret = DecoSrcRun(&pool, src);  // Rest of trace
+#if NEXRV_THREADS
+  pthread_mutex_destroy(&pool.lock);
+#endif
+  *pSrc = pool.n;
+
+  for (int k = 0; k < DECO_SRC_MAX; k++)
+  {
+    DECO_SRC *s = src[k];
+    if (s == NULL) continue;
+
+    if (ret == 0 && s->d.waitSync) DecoResyncEnd(&s->d, s->d.bytePos, disp & 0x10);
+    if (s->f != NULL)
+    {
+      if (conf_PcBin && PcBin_WriteClose(&s->pb) < 0 && ret == 0) ret = EmitErrorMsg("Cannot write PCOUT file");
+      fclose(s->f);
+    }
+    if (ret == 0 && (disp & 4)) printf("NexRv/Src: %d: %lu instr\n", s->src, s->d.nInstr);
+
+    DecoAdd(sum, &s->d);
+    DecoTerm(&s->d);
+    free(s->p);
+    free(s);
+  }
+
+  return ret;
+}
+
+#endif
+
+// Decode trace to PCOUT file 'f'. Returns 0 or error, '*pInstr' is number of
+// decoded instructions (of requested part only with -from/-offset/-count).
+int NexusDeco(FILE *f, int disp, uint64_t *pInstr)
+{
+  NexRvFile nf;
+  if (NexRvFile_Open(&nf, fNex) < 0) return EmitErrorMsg("Cannot read NEX file");
+
+  // Make sure decoder is using real call-stack ...
+  if (conf_CallStack < 0)
+  {
+    conf_CallStack = -conf_CallStack;
+  }
+
+  NexusMsgInit();   // TCODE look-up table (before any thread is started)
+
+  int window = (conf_From != 0 || conf_Count != 0 || conf_Offset != ~(uint64_t)0);
+  if (conf_nSrc > 0 && window)
+  {
+    NexRvFile_Close(&nf);
+    return EmitErrorMsg("Option -src-bits cannot be used with -from/-offset/-count");
+  }
+  if (conf_nSrc > 0 && conf_Ipc != NULL)
+  {
+    NexRvFile_Close(&nf);
+    return EmitErrorMsg("Option -src-bits cannot be used with -ipc");
+  }
+  NexRvPcBin pb;
+  NexRvPcBin *pcBin = NULL;
+  if (conf_PcBin && conf_nSrc == 0)
+  {
+    // All PCs go to binary writer (annotations of -full are not stored)
+    if (PcBin_WriteOpen(&pb, f) < 0) return EmitErrorMsg("Cannot write PCOUT file");
+    pcBin = &pb;
+  }
+
+  NexRvDeco d;
+  DecoInit(&d, (pcBin != NULL) ? NULL : f, pcBin, conf_CallStack);
+  d.resync = conf_Resync;
+  if (conf_Profile != NULL && DecoProfInit(&d) < 0) return EmitErrorMsg("Not enough memory");
+  if (conf_Folded != NULL && DecoFoldInit(&d) < 0) return EmitErrorMsg("Not enough memory");
+  if (conf_Coverage != NULL && DecoCovInit(&d) < 0) return EmitErrorMsg("Not enough memory");
+
+  FILE *fIpc = NULL;
+  if (conf_Ipc != NULL)
+  {
+    // Windows are written while decoding (memory does not depend on trace size)
+    fIpc = fopen(conf_Ipc, "wt");
+    if (fIpc == NULL) return EmitErrorMsg("Cannot create IPC file");
+    if (DecoIpcInit(&d, fIpc, conf_Window) < 0) return EmitErrorMsg("Not enough memory");
+  }
+
+  uint64_t startInstr = 0;
+  if (window)
+  {
+    // Start decoding from closest sync message before requested instruction (or offset)
+    uint64_t startPos = 0;
+    FILE *fIdx = fopen(conf_Index, "rt");
+    if (fIdx == NULL) return EmitErrorMsg("Cannot open index file (create it by -index)");
+    int found;
+    if (conf_Offset != ~(uint64_t)0)
+      found = DecoIndexFind(fIdx, ~(uint64_t)0, conf_Offset, &startPos, &startInstr, &d);
+    else
+      found = DecoIndexFind(fIdx, conf_From, ~(uint64_t)0, &startPos, &startInstr, &d);
+    fclose(fIdx);
+    if (found < 0) return EmitErrorMsg("Index file is not valid");
+    if (NexRvFile_Seek(&nf, startPos) < 0) return EmitErrorMsg("Cannot seek in NEX file");
+
+    d.nInstr  = startInstr;   // Instructions are numbered as from start of file
+    d.outFrom = (conf_Offset != ~(uint64_t)0) ? startInstr : conf_From;
+    if (conf_Count != 0) d.outTo = d.outFrom + conf_Count;
+
+    if (disp & 4) printf("NexRv/Index: start at offset 0x%lX (instr %lu)\n", startPos, startInstr);
+  }
+
+  double t = NexRvFile_Seconds();
+  int ret;
+  int nSeg = 1;
+  int nSrc = 0;
+  uint64_t nBytes;
+  if (conf_nSrc > 0)
+  {
+    // Multi-hart trace (PCOUT file for each hart)
+    ret = NexusDecoSrc(&nf, disp, &d, &nSrc);
+    nBytes = NEXRV_FILE_POS(&nf);
+  }
+  else
+  if (conf_Jobs > 1 && nf.pMap != NULL && (disp & 0xB) == 0 && !window && conf_Folded == NULL && conf_Ipc == NULL)
+  {
+    // Parallel decoding requires mapped file and no per-message display (and
+    // no -folded, as call-stack at start of segment is not known, and no -ipc,
+    // as windows are written in time order)
+    ret = NexusDecoParallel(&nf, f, pcBin, disp, &d, &nSeg);
+    nBytes = nf.mapSize;
+  }
+  else
+  {
+    uint64_t pos = NEXRV_FILE_POS(&nf);
+    ret = NexusDecoFile(&d, &nf, disp);
+    nBytes = NEXRV_FILE_POS(&nf) - pos;
+  }
+  t = NexRvFile_Seconds() - t;
+
+  if (window && ret >= 0)
+  {
+    // Statistics and number of instructions are for decoded part only
+    uint64_t last = (d.nInstr < d.outTo) ? d.nInstr : d.outTo;
+    *pInstr = (last > d.outFrom) ? last - d.outFrom : 0;
+    d.nInstr -= startInstr;
+  }
+  else
+  {
+    *pInstr = d.nInstr;
+  }
+
+  if (pcBin != NULL)
+  {
+    if (PcBin_WriteClose(pcBin) < 0 && ret >= 0) ret = EmitErrorMsg("Cannot write PCOUT file");
+  }
+
+  if (conf_Profile != NULL && ret >= 0)
+  {
+    FILE *fProf = fopen(conf_Profile, "wt");
+    if (fProf == NULL) ret = EmitErrorMsg("Cannot create profile file");
+    else
+    {
+      if (DecoProfWrite(fProf, d.prof, disp) < 0) ret = -1;
+      fclose(fProf);
+    }
+  }
+
+  if (conf_Folded != NULL && ret >= 0)
+  {
+    FILE *fFold = fopen(conf_Folded, "wt");
+    if (fFold == NULL) ret = EmitErrorMsg("Cannot create folded-stack file");
+    else
+    {
+      DecoFoldWrite(fFold, d.fold, disp);
+      fclose(fFold);
+    }
+  }
+
+  if (conf_Coverage != NULL && ret >= 0)
+  {
+    FILE *fCov = fopen(conf_Coverage, "wb");
+    if (fCov == NULL) ret = EmitErrorMsg("Cannot create coverage file");
+    else
+    {
+      if (Cov_Write(d.cov, fCov) < 0) ret = EmitErrorMsg("Cannot write coverage file");
+      fclose(fCov);
+      if (ret >= 0 && (disp & 4)) Cov_Report(d.cov, NULL, disp);
+    }
+  }
+
+  if (fIpc != NULL)
+  {
+    if (ret >= 0 && DecoIpcWrite(d.ipc, disp) < 0) ret = -1;
+    fclose(fIpc);
+  }
+
+  if (ret >= 0 && (disp & 4))
+  {
+    if (nSeg > 1) printf("NexRv/Parallel: %d segments\n", nSeg);
+    if (nSrc > 0) printf("NexRv/Src: %d harts\n", nSrc);
+    DecoStat(&d, disp);
+
+    double mb = ((double)nBytes) / (1024 * 1024);
+    printf("Speed: %.2lf MB in %.3lf sec", mb, t);
+    if (t > 0) printf(", %.2lf MB/s", mb / t);
+    printf("\n");
+  }
+
+  DecoTerm(&d);
+  NexRvFile_Close(&nf);
+  return ret;
+}
+
+#endif  // !NEXRV_LIB
+
 //****************************************************************************
 // End of NexRvDeco.c file
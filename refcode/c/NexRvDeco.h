@@ -0,0 +1,61 @@
+/*
+* Copyright (c) 2020 IAR Systems AB.
+*
+* Permission to use, copy, modify, and distribute this software for any
+* purpose with or without fee is hereby granted, provided that the above
+* copyright notice and this permission notice appear in all copies.
+*
+* THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+* WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+* ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+* WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+* ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+* OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//****************************************************************************
+// File NexRvDeco.h  - Nexus RISC-V Trace decoder library API
+
+// Push-based decoder for use inside of other tools (probe software, IDE).
+// Trace bytes are given in chunks of any size (message may be split between
+// NexRvDeco_Feed calls) and each decoded instruction is reported by callback.
+// Decoder instances are independent (no static state), so many of them may
+// run in parallel (one per thread or per trace source).
+//
+// Instruction information must be loaded by InfoInit (and code images of
+// processes by InfoProcessAdd, see NexRvInfo.h) before first instance is
+// created. It is shared (read-only) by all instances. Each instance selects
+// its own code image by Ownership messages of its trace.
+//
+// Library is built by 'make lib' (NexRvDeco.c compiled with -DNEXRV_LIB=1).
+
+#ifndef NEXRVDECO_H
+#define NEXRVDECO_H
+
+#include <stddef.h> // For size_t
+
+#include "NexRv.h"  // For Nexus_TypeAddr
+
+typedef struct NEXRV_DECO NexRvDeco;  // Decoder instance (opaque)
+
+// Called for each decoded instruction ('info' is INFO_... bits of NexRvInfo.h)
+typedef void (*NexRvDeco_InstrFn)(void *user, Nexus_TypeAddr pc, unsigned int info);
+
+extern NexRvDeco *NexRvDeco_Create(NexRvDeco_InstrFn fn, void *user);       // NULL if no memory
+extern int        NexRvDeco_Feed(NexRvDeco *d, const unsigned char *p, size_t len); // <0 on error
+extern int        NexRvDeco_Flush(NexRvDeco *d);     // End of stream (-1 if last message is not complete)
+extern void       NexRvDeco_Reset(NexRvDeco *d);     // Forget all state (e.g. after error or trace gap)
+extern uint64_t   NexRvDeco_InstrCount(const NexRvDeco *d);
+extern void       NexRvDeco_SetResync(NexRvDeco *d, int on);  // Continue after errors (from next sync message)
+extern void       NexRvDeco_SetSeqJump(NexRvDeco *d, int on); // Trace was encoded with -seqjump
+extern void       NexRvDeco_SetMsbExt(NexRvDeco *d, int on);  // Trace was encoded with -msbext
+extern int        NexRvDeco_SetCallStack(NexRvDeco *d, int depth); // Call-stack depth (-cs of encoder, 32 is default)
+extern uint64_t   NexRvDeco_LostBytes(const NexRvDeco *d);    // Bytes skipped after errors
+extern int        NexRvDeco_Time(const NexRvDeco *d, uint64_t *pTime); // Time of current message (0 if not known)
+extern void       NexRvDeco_Destroy(NexRvDeco *d);
+
+#endif  // NEXRVDECO_H
+
+//****************************************************************************
+// End of NexRvDeco.h file
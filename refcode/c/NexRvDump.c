@@ -30,29 +30,35 @@
 
 #include "NexRv.h"    //  Common NEXUS_... #define (RISC-V specific subset)
 #include "NexRvMsg.h" //  Definition of Nexus messages
+#include "NexRvFile.h" //  Reading of Nexus file (NEXRV_FILE_GET)
+#include "NexRvScan.h" //  Skipping of idles (NexRvScan_Idle)
 
 // Decoder works on two files and dumper on first file
 extern FILE *fNex; // Nexus messages (binary bytes)
+extern int conf_nSrc;   // Size of SRC field
 
-// Dump all Nexus messages (from 'fNex' file)
+// Dump all Nexus messages (from 'nf' file)
 //  disp  - display options bit-mask (1-packets, 2-only TCODE+names, 4-summary)
-int NexusDump(FILE *f, int disp)
+static int NexusDumpFile(NexRvFile *nf, FILE *f, int disp)
 {
   int fldDef  = -1;          
   int fldBits = 0;          
   Nexus_TypeField fldVal = 0;
+  Nexus_TypeField fields[NEXF_MAX];  // Fixed fields of current message (see NexusMsgNextVar)
 
   int msgCnt    = 0;
   int msgBytes  = 0;
   int msgErrors = 0;
   int idleCnt   = 0;
 
+  NexusMsgInit();   // TCODE look-up table
+
   unsigned char msgByte = 0;
   unsigned char prevByte = 0;
   for (;;)
   {
     prevByte = msgByte;
-    if (fread(&msgByte, 1, 1, fNex) != 1) break;  // EOF
+    if (!NEXRV_FILE_GET(nf, msgByte)) break;  // EOF
 
 #if 1 // This will skip long sequnece of idles (visible in true captures ...)
     if (msgByte == 0xFF && prevByte == 0xFF)
@@ -60,6 +66,13 @@ int NexusDump(FILE *f, int disp)
       idleCnt++;
       continue;
     }
+    if (msgByte == 0xFF)
+    {
+      // Following idles (in current block) are skipped in bulk
+      size_t n = NexRvScan_Idle(nf->pCur, (size_t)(nf->pEnd - nf->pCur));
+      nf->pCur += n;
+      idleCnt  += (int)n;
+    }
 #endif
 
     if (disp & 1)
@@ -101,15 +114,7 @@ int NexusDump(FILE *f, int disp)
         return -2;  // Error return
       }
 
-      for (int d = 0; nexusMsgDef[d].def != 0; d++)
-      {
-        if ((nexusMsgDef[d].def & 0x100) == 0) continue;
-        if ((nexusMsgDef[d].def & 0xFF) == mdo)
-        {
-          fldDef = d; // Found TCODE
-          break;
-        }
-      }
+      fldDef = nexusMsgTcode[mdo];
 
       if (fldDef < 0)
       {
@@ -117,6 +122,9 @@ int NexusDump(FILE *f, int disp)
         return -3;
       }
 
+      memset(fields, 0, sizeof(fields));
+      fields[NEXF_TCODE] = mdo;
+
       if (disp & 3) fprintf(f, " TCODE[6]=%d (MSG #%d) - %s\n", mdo, msgCnt, nexusMsgDef[fldDef].name);
       msgCnt++;
       msgBytes++;
@@ -141,14 +149,15 @@ int NexusDump(FILE *f, int disp)
       int fldSize = nexusMsgDef[fldDef].def & 0xFF;
       if (fldSize & 0x80)
       {
-        // Size of this field is defined by parameter ...
-        fldSize = 2;
+        // Size of this field is defined by parameter (only SRC is such)
+        fldSize = conf_nSrc;
       }
       if (fldBits < fldSize)
       {
         break;  // Not enough bits for this field
       }
-      if (disp & 1) fprintf(f, " %s[%d]=0x%lX", nexusMsgDef[fldDef].name, fldSize, fldVal & ((((Nexus_TypeField)1) << fldSize) - 1));
+      fields[nexusMsgDef[fldDef].fld] = fldVal & ((((Nexus_TypeField)1) << fldSize) - 1);
+      if ((disp & 1) && fldSize > 0) fprintf(f, " %s[%d]=0x%lX", nexusMsgDef[fldDef].name, fldSize, fields[nexusMsgDef[fldDef].fld]);
       fldDef++;
       fldVal >>= fldSize;
       fldBits -= fldSize;
@@ -171,7 +180,7 @@ int NexusDump(FILE *f, int disp)
       }
       else
       {
-        fldDef++;
+        fldDef = NexusMsgNextVar(fldDef, fields);
       }
       fldBits = 0;
       fldVal  = 0;
@@ -195,5 +204,27 @@ int NexusDump(FILE *f, int disp)
   return msgCnt; // Number of messages handled
 }
 
+// Dump all Nexus messages (from 'fNex' file)
+int NexusDump(FILE *f, int disp)
+{
+  NexRvFile nf;
+  if (NexRvFile_Open(&nf, fNex) < 0) return -5;
+
+  double t = NexRvFile_Seconds();
+  int ret = NexusDumpFile(&nf, f, disp);
+  t = NexRvFile_Seconds() - t;
+
+  if (ret >= 0 && (disp & 4))
+  {
+    double mb = ((double)NEXRV_FILE_POS(&nf)) / (1024 * 1024);
+    printf("Speed: %.2lf MB in %.3lf sec", mb, t);
+    if (t > 0) printf(", %.2lf MB/s", mb / t);
+    printf("\n");
+  }
+
+  NexRvFile_Close(&nf);
+  return ret;
+}
+
 //****************************************************************************
 // End of NexRvDump.c file
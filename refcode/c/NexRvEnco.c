@@ -25,21 +25,28 @@
 
 #include <stdio.h>  //  For NULL, 'printf', 'fopen, ...'
 #include <stdlib.h> //  For 'exit'
-#include <string.h> //  For 'strcmp', 'strchr' 
+#include <string.h> //  For 'strcmp', 'strchr', 'memcmp'
 #include <ctype.h>  //  For 'isspace/isxdigit' etc.
+#include <inttypes.h>   //  For scan format SCNu64
 
 #include "NexRv.h"      //  Common NEXUS_... #define (RISC-V specific subset)
 #include "NexRvInfo.h"  
+#include "NexRvFile.h"  //  Binary PCSEQ is memory-mapped
+#include "NexRvPcBin.h" //  Binary PCSEQ format
 
 extern FILE *fNex; // Nexus messages (binary bytes)
 
 extern int conf_Repeat;
+extern int conf_Sync;
+extern int conf_Tstamp;
+extern int conf_SeqJump;
+extern int conf_MsbExt;
+extern int conf_IcntBits;
+extern int conf_nSrc;
 
 #if 1 // Callstack related
 extern int conf_CallStack;
-extern void CallStack_Init();
-extern void CallStack_Push(Nexus_TypeAddr ret);
-extern Nexus_TypeAddr CallStack_Pop();
+static NexRvCallStack encoCallStack;
 
 static unsigned int checkRetNext = 1; // Impossible to match with real-pc
 #endif
@@ -53,10 +60,107 @@ static unsigned int encoICNT;
 static Nexus_TypeHist encoHIST;
 static Nexus_TypeAddr encoADDR;
 static unsigned int encoBCNT;
+static unsigned int encoSyncCnt;  // Instructions since last sync message (for -sync)
+static uint64_t encoCycle;        // Cycle of last retired instruction (for -tstamp)
+static uint64_t encoTstampPrev;   // Cycle of last TSTAMP
+static int encoStat_Tstamps = 0;
+static int encoOwnership;         // Process was changed (Ownership message at next instruction)
+static uint64_t encoProcess;      // Process (from '.process <id>' lines of PCSEQ)
+static int encoProcValid;         // 'encoProcess' was given
+static int encoStat_Ownership = 0;
+static Nexus_TypeAddr encoNextPc; // Address after last retired instruction (for -seqjump)
+static int encoStat_SeqJump = 0;
+static int encoIcntFull;          // ResourceFull is I-CNT overflow (RCODE=0), not HIST full (for -icnt)
+static int encoStat_IcntFull = 0;
 
 static unsigned int prevICNT;
 static Nexus_TypeHist prevHIST;
 
+#if 1 // Multi-hart trace (SRC field, see -src-bits)
+
+typedef struct ENCO_SRCBUF
+{
+  unsigned char *p;     // Messages of one source (with SRC field)
+  size_t        size;
+  size_t        cap;
+  size_t        rd;     // Next message to be merged
+} ENCO_SRCBUF;
+
+static ENCO_SRCBUF  *encoSrcBuf = NULL; // Buffer of current source (NULL if SRC is not used)
+static unsigned int encoSrc     = 0;    // SRC of current source
+
+// Append message[s] to 'encoSrcBuf' with 'conf_nSrc' bits of SRC inserted after
+// each TCODE. Fixed fields and first variable field are shifted by SRC bits, so
+// this part may need one more MDO. Returns number of bytes (or -1).
+static int EncoPutSrc(const unsigned char *msg, int len)
+{
+  ENCO_SRCBUF *b = encoSrcBuf;
+  if (b->size + 2 * len + 16 > b->cap)
+  {
+    size_t cap = (b->cap == 0) ? 0x10000 : 2 * b->cap;
+    unsigned char *p = (unsigned char *)realloc(b->p, cap);
+    if (p == NULL) return -1;
+    b->p   = p;
+    b->cap = cap;
+  }
+
+  size_t start = b->size;
+  int i = 0;
+  while (i < len)
+  {
+    b->p[b->size++] = msg[i++];   // TCODE
+
+    unsigned int acc  = encoSrc;  // Bits not yet written (SRC is first)
+    int          nb   = conf_nSrc;
+    unsigned int mseo = 0;
+    while (i < len && mseo == 0)
+    {
+      mseo = msg[i] & 0x3;
+      acc |= (unsigned int)(msg[i++] >> 2) << nb;
+      nb  += 6;
+      while (nb > 6 || (nb == 6 && mseo == 0))
+      {
+        b->p[b->size++] = (acc & 0x3F) << 2;
+        acc >>= 6;
+        nb   -= 6;
+      }
+    }
+    b->p[b->size++] = ((acc & 0x3F) << 2) | mseo; // End of first variable field
+
+    while (i < len && mseo != 3)
+    {
+      mseo = msg[i] & 0x3;
+      b->p[b->size++] = msg[i++];   // Other fields are not changed
+    }
+  }
+  return (int)(b->size - start);
+}
+
+// Write messages of all sources to 'fNex' (one message of each source in turn)
+static int EncoMergeSrc(ENCO_SRCBUF *buf, int nSrc)
+{
+  int more = 1;
+  while (more)
+  {
+    more = 0;
+    for (int k = 0; k < nSrc; k++)
+    {
+      ENCO_SRCBUF *b = &buf[k];
+      if (b->rd >= b->size) continue;
+
+      size_t e = b->rd;
+      while (e < b->size && (b->p[e] & 0x3) != 0x3) e++;
+      e++;  // Include last byte of message
+      if (fwrite(b->p + b->rd, 1, e - b->rd, fNex) != e - b->rd) return -1;
+      b->rd = e;
+      more  = 1;
+    }
+  }
+  return 0;
+}
+
+#endif
+
 static int AddVar(Nexus_TypeField v, int nPrev, unsigned char *msg, int pos)
 {
   if (nPrev > 0)
@@ -74,6 +178,46 @@ static int AddVar(Nexus_TypeField v, int nPrev, unsigned char *msg, int pos)
   return pos;
 }
 
+// Append U-ADDR/F-ADDR field (address without LSB). With -msbext identical MSB
+// bits are skipped (1-s as well as 0-s), as decoder extends MSB of last MDO
+// up to bit #63 of address. Kernel address like 0xFFFFFFFF800031F4 takes
+// 5 MDOs instead of 11 then (but 0-s need extra MDO if MSB of last one is 1).
+static int AddAddr(Nexus_TypeField v, int nPrev, unsigned char *msg, int pos)
+{
+  if (!conf_MsbExt || (v == 0 && nPrev >= 0)) return AddVar(v, nPrev, msg, pos);
+
+  int64_t s = ((int64_t)(v << 1)) >> 1;  // Bit #62 of field (bit #63 of address) is extended
+  for (;;)
+  {
+    int mdo = (int)(s & 0x3F);
+    msg[pos++] = (unsigned char)(mdo << 2);
+    s >>= 6;  // Arithmetic shift (rest of field)
+    if (s == ((mdo & 0x20) ? -1 : 0)) break;  // Rest is extension of this MDO
+  }
+  msg[pos - 1] |= 1; // Set MSEO='01' at last byte
+  return pos;
+}
+
+// Append TSTAMP field (time of last retired instruction) if requested by -tstamp.
+// It is absolute in sync messages (decoding may start there) and relative to
+// previous TSTAMP in other messages (only if at least 'conf_Tstamp' cycles passed).
+static int AddTstamp(int sync, unsigned char *msg, int pos)
+{
+  if (conf_Tstamp == 0) return pos;
+  if (sync)
+  {
+    pos = AddVar(encoCycle, -1, msg, pos);  // Present even if 0
+  }
+  else
+  {
+    if (encoCycle - encoTstampPrev < (uint64_t)conf_Tstamp) return pos;
+    pos = AddVar(encoCycle - encoTstampPrev, 0, msg, pos);
+  }
+  encoTstampPrev = encoCycle;
+  encoStat_Tstamps++;
+  return pos;
+}
+
 // *********************************************************
 // A little bit HIST pattern detection (maybe ***)
 //
@@ -170,7 +314,7 @@ static int IsHistMatch_30_28(unsigned int prev32, unsigned int hist32)
 }
 
 // Handle retired instruction (it may be implemented as HW pipeline)
-static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int disp)
+static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, uint64_t cycle, int level, int disp)
 {
   if (disp & 2) printf("Enco: pc=0x%lX,info=0x%X\n", addr, info);
 
@@ -181,11 +325,16 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
     encoHIST = 1;
     encoADDR = 0;
     encoBCNT = 0;
+    encoSyncCnt = 0;
 
     prevICNT = 0;
     prevHIST = 0; // Will never match ...
 
+    encoCycle      = (cycle > 0) ? cycle - 1 : 0;  // First message is before first instruction
+    encoTstampPrev = encoCycle;
+
     encoNextEmit = NEXUS_TCODE_ProgTraceSync;
+    encoNextPc   = 1;
   }
 
   if (conf_CallStack != 0 && (checkRetNext & 1) == 0)
@@ -198,6 +347,24 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
     checkRetNext = 1;   // This is one time deal
   }
 
+  if (info != 0 && encoNextEmit == 0 && level >= 20 && conf_Sync > 0 && encoSyncCnt >= (unsigned int)conf_Sync)
+  {
+    // Periodic sync (between indirect jumps). HIST tells decoder all branches
+    // before this point, so it will be sent as IndirectBranchHistSync (BTYPE=0).
+    encoNextEmit = NEXUS_TCODE_IndirectBranchHist;
+  }
+
+  // Process is changed at this instruction. All previous instructions are sent
+  // by sync message with this address (by IndirectBranchHistSync, just as for
+  // periodic sync) and Ownership message follows it (decoder switches code
+  // image before next instructions).
+  int ownNow = (info != 0 && encoOwnership);
+  if (ownNow && (encoNextEmit == 0 || encoNextEmit == NEXUS_TCODE_ResourceFull))
+  {
+    // HIST may be full (31 bits) - it fits to IndirectBranchHistSync as well
+    encoNextEmit = (level >= 20) ? NEXUS_TCODE_IndirectBranchHist : NEXUS_TCODE_IndirectBranch;
+  }
+
   if (info == 0 && (encoICNT > 0 || histRepeat_Bits != 0))  // Flush requested
   {
     if (encoNextEmit == 0) encoNextEmit = NEXUS_TCODE_ProgTraceCorrelation;
@@ -207,12 +374,33 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
     }
   }
 
+  // I-CNT counter (-icnt) must hold this and next instruction (when HIST full is
+  // pending, its message does not reset I-CNT). Otherwise all counted instructions
+  // are sent by ResourceFull (RCODE=0) before this one. Decoder adds its RDATA to
+  // I-CNT of next message with I-CNT.
+  encoIcntFull = 0;
+  if (info != 0 && encoNextEmit == 0 && conf_IcntBits > 0 && encoICNT > 0 &&
+      encoICNT + 4 > (unsigned int)((((uint64_t)1) << conf_IcntBits) - 1))
+  {
+    encoNextEmit = NEXUS_TCODE_ResourceFull;
+    encoIcntFull = 1;
+  }
+
   if (encoNextEmit != 0)
   {
     if (disp & 8) printf("Enco: EMIT=%d, hist=0x%X, encoICNT=%d\n", encoNextEmit, encoHIST, encoICNT);
 
+    // Periodic sync: branch message is sent as sync variant (with full address)
+    int syncNow = (ownNow && encoNextEmit != NEXUS_TCODE_ProgTraceSync);
+    if (conf_Sync > 0 && encoSyncCnt >= (unsigned int)conf_Sync &&
+        (encoNextEmit == NEXUS_TCODE_IndirectBranchHist || encoNextEmit == NEXUS_TCODE_IndirectBranch ||
+         encoNextEmit == NEXUS_TCODE_DirectBranch))
+    {
+      syncNow = 1;
+    }
+
 
-    unsigned char msg[40];
+    unsigned char msg[128];
     int  pos = 0;
 
     if (level >= 21)  // This piece of code detects and generates Repeat Branch message
@@ -220,7 +408,7 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
       int repeatNow = 0;
 
       // Detect 24/30-bit ResourceFull pattern match      
-      if ((conf_Repeat & 2)  && encoNextEmit == NEXUS_TCODE_ResourceFull)
+      if ((conf_Repeat & 2)  && encoNextEmit == NEXUS_TCODE_ResourceFull && !encoIcntFull)
       {
         // if (1) printf("Enco: FULL(%d) = 0x%X\n", histRepeat_Bits, encoHIST);
         if (histRepeat_Bits == 0)
@@ -277,7 +465,7 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
       }
       else
       // Repeat of 'IndirectBranchHistory' (and Direct/IndirectBranch as well)
-      if ((conf_Repeat & 1) && (encoNextEmit != NEXUS_TCODE_ResourceFull) && (prevHIST == encoHIST) && (encoADDR == addr) && (prevICNT == encoICNT))
+      if ((conf_Repeat & 1) && !syncNow && (encoNextEmit != NEXUS_TCODE_ResourceFull) && (prevHIST == encoHIST) && (encoADDR == addr) && (prevICNT == encoICNT))
       {
         // IndirectBranchHistory message back to same address
         repeatNow = 1;
@@ -305,7 +493,7 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
           }
           else
           {
-            msg[pos++] = 0x1 << 2; // RCODE:N=0 (HIST full)
+            msg[pos++] = 0x1 << 2; // RCODE:N=1 (HIST full)
           }
           pos = AddVar(histRepeat_Prev, 6 - NEXUS_FLDSIZE_RCODE, msg, pos);
 
@@ -313,6 +501,7 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
           {
             pos = AddVar(encoBCNT, 0, msg, pos);  // Repeat count ...
           }
+          pos = AddTstamp(0, msg, pos);
           msg[pos - 1] |= 3; // Set MSEO='11' at last byte
 
           // if (1) printf("Enco: FULL_EMIT(%d) = 0x%X\n", histRepeat_Bits, histRepeat_Prev);
@@ -320,7 +509,7 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
           encoStat_MsgCnt++;
 
           // Make sure this one will be compared next time
-          if (encoNextEmit == NEXUS_TCODE_ResourceFull)
+          if (encoNextEmit == NEXUS_TCODE_ResourceFull && !encoIcntFull)
           {
             histRepeat_Bits   = 31; // NEXUS_HIST_BITS;
             histRepeat_Shift  = 0;  // No shift
@@ -344,6 +533,7 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
           // We must produce RepeatBranch message before this one ...
           msg[pos++] = NEXUS_TCODE_RepeatBranch << 2;
           pos = AddVar(encoBCNT, 0, msg, pos);
+          pos = AddTstamp(0, msg, pos);
           msg[pos - 1] |= 3; // Set MSEO='11' at last byte
 
           encoStat_MsgCnt++;
@@ -366,6 +556,16 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
       prevHIST = 0; // Only messages which should be repeated will set it
     }
 
+    if (syncNow)
+    {
+      if (encoNextEmit == NEXUS_TCODE_IndirectBranchHist)
+        encoNextEmit = NEXUS_TCODE_IndirectBranchHistSync;
+      else if (encoNextEmit == NEXUS_TCODE_IndirectBranch)
+        encoNextEmit = NEXUS_TCODE_IndirectBranchSync;
+      else
+        encoNextEmit = NEXUS_TCODE_DirectBranchSync;
+    }
+
     if (encoNextEmit != 0)
     {
       msg[pos++] = encoNextEmit << 2;
@@ -376,7 +576,7 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
       msg[pos++] = 0x1 << 2;  // SYNC:4=1 (always)
       pos = AddVar(encoICNT, 6 - 4, msg, pos);
       encoICNT = 0; // Reset after sending
-      pos = AddVar(addr >> NEXUS_PARAM_AddrSkip, 0, msg, pos);
+      pos = AddAddr(addr >> NEXUS_PARAM_AddrSkip, 0, msg, pos);
       encoADDR = addr;  // This is new address
     }
     else if (encoNextEmit == NEXUS_TCODE_IndirectBranchHist || encoNextEmit == NEXUS_TCODE_IndirectBranch)
@@ -387,7 +587,7 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
       msg[pos++] = 0x0 << 2;  // BTYPE:2=0 (always)
       pos = AddVar(encoICNT, 6 - 2, msg, pos);
       encoICNT = 0; // Reset after sending
-      pos = AddVar((encoADDR ^ addr) >> NEXUS_PARAM_AddrSkip, -1, msg, pos);
+      pos = AddAddr((encoADDR ^ addr) >> NEXUS_PARAM_AddrSkip, -1, msg, pos);
       encoADDR = addr;  // This is new address
 
       if (encoNextEmit == NEXUS_TCODE_IndirectBranchHist)
@@ -395,16 +595,44 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
         pos = AddVar(encoHIST, 0, msg, pos);
       }
     }
+    else if (encoNextEmit == NEXUS_TCODE_IndirectBranchHistSync || encoNextEmit == NEXUS_TCODE_IndirectBranchSync)
+    {
+      msg[pos++] = ((0x0 << 4) | 0x2) << 2;  // BTYPE:2=0, SYNC:4=2 (periodic)
+      pos = AddVar(encoICNT, -1, msg, pos);
+      encoICNT = 0; // Reset after sending
+      pos = AddAddr(addr >> NEXUS_PARAM_AddrSkip, 0, msg, pos);
+      encoADDR = addr;  // This is new address
+
+      if (encoNextEmit == NEXUS_TCODE_IndirectBranchHistSync)
+      {
+        pos = AddVar(encoHIST, 0, msg, pos);
+      }
+    }
+    else if (encoNextEmit == NEXUS_TCODE_DirectBranchSync)
+    {
+      msg[pos++] = 0x2 << 2;  // SYNC:4=2 (periodic)
+      pos = AddVar(encoICNT, 6 - 4, msg, pos);
+      encoICNT = 0; // Reset after sending
+      pos = AddAddr(addr >> NEXUS_PARAM_AddrSkip, 0, msg, pos);
+      encoADDR = addr;  // This is new address
+    }
     else if (encoNextEmit == NEXUS_TCODE_DirectBranch)
     {
       pos = AddVar(encoICNT, -1, msg, pos);
       encoICNT = 0; // Reset after sending
+    } else if (encoNextEmit == NEXUS_TCODE_ResourceFull && encoIcntFull)
+    {
+      prevHIST = 0;         // Next message is not a repeat (its I-CNT is only a part)
+
+      msg[pos++] = 0x0 << 2; // RCODE:N=0 (I-CNT full)
+      pos = AddVar(encoICNT, 6 - NEXUS_FLDSIZE_RCODE, msg, pos);
+      encoICNT = 0; // Reset after sending
+      encoStat_IcntFull++;
     } else if (encoNextEmit == NEXUS_TCODE_ResourceFull)
     {
       prevHIST = encoHIST;  // Save to check for repeat next time ...
       prevICNT = encoICNT;
 
-      // TODO See if this is ICNT or HIST. For now only HIST is handled
       if (NEXUS_FLDSIZE_RCODE != 0)
       {
         msg[pos++] = 0x1 << 2; // RCODE:N=1 (HIST full)
@@ -425,25 +653,66 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
       }
     }
 
+    if (encoNextEmit != 0)
+    {
+      pos = AddTstamp(encoNextEmit == NEXUS_TCODE_ProgTraceSync || encoNextEmit == NEXUS_TCODE_DirectBranchSync ||
+                      encoNextEmit == NEXUS_TCODE_IndirectBranchSync || encoNextEmit == NEXUS_TCODE_IndirectBranchHistSync, msg, pos);
+    }
+
+    if (ownNow)
+    {
+      msg[pos - 1] |= 3; // End of sync message
+      msg[pos++] = NEXUS_TCODE_Ownership << 2;
+      pos = AddVar(encoProcess, -1, msg, pos);  // Present even if 0
+      pos = AddTstamp(0, msg, pos);
+      encoOwnership = 0;
+      encoStat_MsgCnt++;
+      encoStat_Ownership++;
+    }
+
     if (pos > 1)
     {
       msg[pos - 1] |= 3; // Set MSEO='11' at last byte
       
+      if (encoSrcBuf != NULL)
+      {
+        pos = EncoPutSrc(msg, pos);
+        if (pos < 0) return -1;
+      }
+      else
       if (fwrite(msg, 1, pos, fNex) != pos) return -1;
       encoStat_MsgBytes += pos;
       encoStat_MsgCnt++;
     }
 
+    if (syncNow || encoNextEmit == NEXUS_TCODE_ProgTraceSync)
+    {
+      // Sync message resets encoder state (decoding may start from here)
+      encoSyncCnt = 0;
+      prevHIST = 0;
+      if (conf_CallStack != 0) CallStack_Init(&encoCallStack, conf_CallStack);
+    }
+
     encoNextEmit = 0;   // Only one time
-    if (histRepeat_Bits == 0)
+    if (histRepeat_Bits == 0 && !encoIcntFull)
     {
       encoHIST = 1; // histRepeat handle 'encoHist' differently ... 
     }
     // encoICNT = 0;
   }
 
+  // Sequential jump (-seqjump): target of 'jr/jalr' is given by 'lui/auipc'
+  // just before it. Decoder knows it, if both are in ICNT of the same message
+  // (no message was sent between them), so it is handled as direct jump.
+  // I-CNT overflow (-icnt) is added to next I-CNT by decoder, so it does not count.
+  int seqJump = (conf_SeqJump && (info & INFO_SEQJUMP) && (encoICNT > 0 || encoIcntFull) && encoNextPc == addr);
+  if (seqJump) encoStat_SeqJump++;
+
   // This is key state update (ICNT and HIST fields)
+  if (info != 0) encoCycle = cycle;
+  if (info != 0) encoNextPc = addr + ((info & INFO_4) ? 4 : 2);
   encoICNT += (info & INFO_4) ? 2 : 1;
+  encoSyncCnt++;
 
   if (info & INFO_BRANCH)
   {
@@ -470,11 +739,11 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
       }
     }    
   }
-  else if (info & INFO_INDIRECT)
+  else if ((info & INFO_INDIRECT) && !seqJump)
   {
     if (conf_CallStack != 0 && (info & INFO_RET))
     {
-      checkRetNext = CallStack_Pop(); // We will check this address on next instruction
+      checkRetNext = CallStack_Pop(&encoCallStack); // We will check this address on next instruction
     }
 
     if (level >= 20)
@@ -491,41 +760,151 @@ static int HandleRetired(Nexus_TypeAddr addr, unsigned int info, int level, int
   {
     // This is call (direct or indirect). Push address after this 'jal[r]) to the stack
     Nexus_TypeAddr ret = addr + ((info & INFO_4) ? 4 : 2);
-    CallStack_Push(ret);
+    CallStack_Push(&encoCallStack, ret);
   }
 
   return 0; // OK
 }
 
+// Next process (from '.process <id>' line or record of PCSEQ)
+static void EncoProcess(uint64_t p)
+{
+  if (!encoProcValid || p != encoProcess) encoOwnership = 1;  // Ownership message at next instruction
+  encoProcess   = p;
+  encoProcValid = 1;
+}
+
+// Get varint of binary PCSEQ (returns 0 at EOF or if it is truncated)
+static int EncoGetVar(NexRvFile *nf, uint64_t *pV)
+{
+  uint64_t v = 0;
+  unsigned char b;
+  for (int shift = 0; shift < 64; shift += 7)
+  {
+    if (!NEXRV_FILE_GET(nf, b)) return 0;
+    v |= ((uint64_t)(b & 0x7F)) << shift;
+    if ((b & 0x80) == 0)
+    {
+      *pV = v;
+      return 1;
+    }
+  }
+  return 0;  // Too long
+}
+
+// Encode binary PCSEQ (see NexRvPcBin.h). File is mapped (or read in big
+// blocks) and records are taken from a pointer, so there is no parsing.
+// Returns <0 for error, '*pAddr' is PC of last instruction.
+static int EncoPcsBin(FILE *f, int level, int disp, Nexus_TypeAddr *pAddr)
+{
+  NexRvFile nf;
+  fseek(f, 0, SEEK_SET);
+  if (NexRvFile_Open(&nf, f) < 0) return -3;  // No memory
+
+  int ret = 0;
+  unsigned char b;
+  for (int k = 0; k < 8; k++) NEXRV_FILE_GET(&nf, b);  // Skip header (it was checked)
+
+  Nexus_TypeAddr next = 0;  // PC after previous instruction
+  uint64_t cycle = 0;
+  while (NEXRV_FILE_GET(&nf, b))
+  {
+    uint64_t v;
+    if (!EncoGetVar(&nf, &v)) { ret = -4; break; }  // Truncated record
+    if (b == 0)
+    {
+      EncoProcess(v);
+      continue;
+    }
+
+    unsigned int info = NEXRV_PCSBIN_INFO_GET(b);
+    uint64_t zz = v >> 1;
+    Nexus_TypeAddr a = next + (Nexus_TypeAddr)((int64_t)(zz >> 1) ^ -(int64_t)(zz & 1));  // un-zigzag
+    if (v & 1)
+    {
+      uint64_t t;
+      if (!EncoGetVar(&nf, &t)) { ret = -4; break; }
+      cycle += t;
+    }
+    else
+    {
+      cycle++;
+    }
+    next = a + ((info & INFO_4) ? 4 : 2);
+    *pAddr = a;
+
+    encoStat_InstrCnt++;
+    ret = HandleRetired(a, info, cycle, level, disp);
+    if (ret < 0) break;
+  }
+
+  NexRvFile_Close(&nf);
+  return ret;
+}
+
 int NexusEnco(FILE *f, int level, int disp)
 {
   encoStat_MsgBytes = 0;
   encoStat_MsgCnt   = 0;
   encoStat_InstrCnt = 0;
+  encoStat_Tstamps  = 0;
+  encoStat_Ownership = 0;
+  encoStat_SeqJump  = 0;
+  encoStat_IcntFull = 0;
+  encoOwnership     = 0;
+  encoProcValid     = 0;
+
+  histRepeat_Bits   = 0;
+  histRepeat_Prev   = 0;
+  histRepeat_Shift  = 0;
 
-  CallStack_Init();
+  if (CallStack_Init(&encoCallStack, conf_CallStack) < 0) return -3;  // No memory
+  checkRetNext = 1;
 
   printf("NexusEnco(level=%d, ...)\n", level);
 
-  Nexus_TypeAddr a;
-  unsigned int info;
+  Nexus_TypeAddr a = 0;
   char line[1000];
-  while (fgets(line, sizeof(line), f) != NULL)
+  if (fread(line, 1, 8, f) == 8 && memcmp(line, NEXRV_PCSBIN_MAGIC, 8) == 0)
   {
-    if (disp & 1) printf("%s", line);
-    if (line[0] == '.' && line[1] == 'e') break; // End
-    if (line[0] == '.') continue; // Comment (ignore this line)
-    if (line[0] == '\0' || line[0] == '\n') continue; // Ignore empty as well ...
+    if (disp & 4) printf("NexRv/Pcseq: binary\n");
+    int ret = EncoPcsBin(f, level, disp, &a);
+    if (ret < 0) return ret;
+  }
+  else
+  {
+    fseek(f, 0, SEEK_SET);  // Text PCSEQ
+
+    unsigned int info;
+    uint64_t cycle = 0;
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+      if (disp & 1) printf("%s", line);
+      if (line[0] == '.' && line[1] == 'e') break; // End
+      if (strncmp(line, ".process ", 9) == 0)
+      {
+        // Next instructions are in this process (Ownership message if it is changed)
+        EncoProcess(strtoull(line + 9, NULL, 0));
+        continue;
+      }
+      if (line[0] == '.') continue; // Comment (ignore this line)
+      if (line[0] == '\0' || line[0] == '\n' || line[0] == '\r') continue; // Ignore empty as well ...
 
-    if (!InfoParse(line, &a, &info, NULL))  return -1;
-    if (info == 0)                          return -2;
+      if (!InfoParse(line, &a, &info, NULL))  return -1;
+      if (info == 0)                          return -2;
 
-    encoStat_InstrCnt++;
-    int ret = HandleRetired(a, info, level, disp);
-    if (ret < 0)  return ret;
+      // Cycle of instruction is '@<cycle>' (next cycle if not given)
+      const char *c = strchr(line, '@');
+      if (c == NULL || sscanf(c + 1, "%" SCNu64, &cycle) != 1) cycle++;
+
+      encoStat_InstrCnt++;
+      int ret = HandleRetired(a, info, cycle, level, disp);
+      if (ret < 0)  return ret;
+    }
   }
 
-  int ret = HandleRetired(a, 0, level, disp);  // Flush ...
+  int ret = HandleRetired(a, 0, encoCycle, level, disp);  // Flush ...
+  CallStack_Free(&encoCallStack);
   if (ret < 0)  return ret;
 
   if (disp & 4)
@@ -533,10 +912,47 @@ int NexusEnco(FILE *f, int level, int disp)
     printf("Stat: %d instr, level=%d.%d => %d bytes, %d messages", encoStat_InstrCnt, level / 10, level % 10, encoStat_MsgBytes, encoStat_MsgCnt);
     if (encoStat_InstrCnt > 0) printf(", %.3lf bits/instr", ((double)encoStat_MsgBytes * 8) / encoStat_InstrCnt);
     printf("\n");
+    if (conf_Tstamp > 0) printf("NexRv/Tstamp: %d timestamps, last at cycle %lu\n", encoStat_Tstamps, encoCycle);
+    if (encoStat_Ownership > 0) printf("NexRv/Process: %d Ownership messages\n", encoStat_Ownership);
+    if (conf_SeqJump) printf("NexRv/SeqJump: %d sequential jumps (no message)\n", encoStat_SeqJump);
+    if (conf_IcntBits > 0) printf("NexRv/Icnt: %d I-CNT overflows (ResourceFull with RCODE=0)\n", encoStat_IcntFull);
   }
 
   return encoStat_MsgCnt;
 }
 
+// Encode trace of 'nSrc' harts (hart #k is in f[k] file and it has SRC=k).
+// Each hart is encoded independently and messages are interleaved.
+int NexusEncoSrc(FILE *f[], int nSrc, int level, int disp)
+{
+  ENCO_SRCBUF *buf = (ENCO_SRCBUF *)calloc(nSrc, sizeof(ENCO_SRCBUF));
+  if (buf == NULL) return -1;
+
+  int ret = 0;
+  int msgCnt = 0;
+  for (int k = 0; k < nSrc; k++)
+  {
+    encoSrc    = k;
+    encoSrcBuf = &buf[k];
+    if (disp & 4) printf("NexRv/Src: %d\n", k);
+
+    ret = NexusEnco(f[k], level, disp);
+    if (ret < 0) break;
+    msgCnt += ret;
+  }
+  encoSrcBuf = NULL;
+
+  if (ret >= 0 && EncoMergeSrc(buf, nSrc) < 0) ret = -1;
+
+  for (int k = 0; k < nSrc; k++)
+  {
+    free(buf[k].p);
+  }
+  free(buf);
+
+  if (ret < 0) return ret;
+  return msgCnt;
+}
+
 //****************************************************************************
 // End of NexRvEnco.c file
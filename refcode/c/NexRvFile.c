@@ -0,0 +1,188 @@
+/*
+* Copyright (c) 2020 IAR Systems AB.
+*
+* Permission to use, copy, modify, and distribute this software for any
+* purpose with or without fee is hereby granted, provided that the above
+* copyright notice and this permission notice appear in all copies.
+*
+* THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+* WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+* ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+* WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+* ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+* OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//****************************************************************************
+// File NexRvFile.c - Nexus file input (memory-mapped or block-buffered)
+
+// Code below is written in plain C-code.
+// It was compiled using VisualC, GNU and IAR C/C++ compiler.
+//  1. Only standard C-types are used.
+//  2. Only few standard C functions used - see notes with "#include <...>"
+//  3. Only non K&R C is 'for (int x' and 'int x;' between instructions.
+//
+// Memory mapping is only used on POSIX systems (it can be disabled by
+// -DNEXRV_MMAP=0). Otherwise file is read in NEXRV_FILE_BLOCK sized blocks.
+// Seek uses 64-bit file offsets ('_fseeki64' on Windows, 'fseeko' on POSIX),
+// as 'long' of 'fseek' is 32 bits on some systems (files over 2GB).
+
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64  // 64-bit 'off_t' on 32-bit POSIX systems
+#endif
+
+#include <stdio.h>  //  For 'fread', 'fseek' (or '_fseeki64', 'fseeko')
+#include <limits.h> //  For LONG_MAX
+#include <stdlib.h> //  For 'malloc', 'free'
+#include <time.h>   //  For 'clock' (or 'clock_gettime')
+
+#ifndef NEXRV_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+#define NEXRV_MMAP 1
+#else
+#define NEXRV_MMAP 0
+#endif
+#endif
+
+#if NEXRV_MMAP
+#include <sys/mman.h> //  For 'mmap', 'munmap'
+#include <sys/stat.h> //  For 'fstat'
+#include <unistd.h>   //  For '_POSIX_TIMERS'
+#endif
+
+#if defined(_WIN32)
+#define NEXRV_SEEK64  1 // '_fseeki64' with '__int64' offset
+#elif defined(__unix__) || defined(__APPLE__)
+#define NEXRV_SEEK64  2 // 'fseeko' with 'off_t' offset
+#include <sys/types.h>  //  For 'off_t'
+#else
+#define NEXRV_SEEK64  0 // 'fseek' with 'long' offset
+#endif
+
+#include "NexRvFile.h"
+
+int NexRvFile_Open(NexRvFile *nf, FILE *f)
+{
+  nf->f         = f;
+  nf->blockPos  = 0;
+  nf->pBuf      = NULL;
+  nf->pMap      = NULL;
+  nf->mapSize   = 0;
+
+#if NEXRV_MMAP
+  struct stat st;
+  if (fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+  {
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+    if (p != MAP_FAILED)
+    {
+      madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+      nf->pMap    = p;
+      nf->mapSize = (uint64_t)st.st_size;
+      nf->pBlock  = (const unsigned char *)p;
+      nf->pCur    = nf->pBlock;
+      nf->pEnd    = nf->pBlock + st.st_size;
+      return 0; // OK (whole file is one block)
+    }
+  }
+#endif
+
+  // Not mapped - we will read it in blocks
+  nf->pBuf = malloc(NEXRV_FILE_BLOCK);
+  if (nf->pBuf == NULL) return -1;
+
+  nf->pBlock  = nf->pBuf;
+  nf->pCur    = nf->pBuf;
+  nf->pEnd    = nf->pBuf;
+  return 0; // OK
+}
+
+// Get next block (returns number of bytes available, 0 means EOF)
+int NexRvFile_Fill(NexRvFile *nf)
+{
+  if (nf->pBuf == NULL) return 0; // Mapped file is a single block
+
+  nf->blockPos += (uint64_t)(nf->pEnd - nf->pBlock);
+
+  size_t n = fread(nf->pBuf, 1, NEXRV_FILE_BLOCK, nf->f);
+  nf->pBlock  = nf->pBuf;
+  nf->pCur    = nf->pBuf;
+  nf->pEnd    = nf->pBuf + n;
+  return (int)n;
+}
+
+// Set file offset of next byte (returns -1 if not possible)
+int NexRvFile_Seek(NexRvFile *nf, uint64_t pos)
+{
+  if (nf->pMap != NULL)
+  {
+    if (pos > nf->mapSize) return -1;
+    nf->blockPos  = 0;
+    nf->pBlock    = (const unsigned char *)nf->pMap;
+    nf->pCur      = nf->pBlock + pos;
+    nf->pEnd      = nf->pBlock + nf->mapSize;
+    return 0; // OK
+  }
+
+#if NEXRV_SEEK64 == 1
+  if (pos > (uint64_t)INT64_MAX) return -1; // Offset cannot be represented
+  if (_fseeki64(nf->f, (__int64)pos, SEEK_SET) != 0) return -1;
+#elif NEXRV_SEEK64 == 2
+  off_t off = (off_t)pos;
+  if (off < 0 || (uint64_t)off != pos) return -1; // Offset cannot be represented
+  if (fseeko(nf->f, off, SEEK_SET) != 0) return -1;
+#else
+  if (pos > (uint64_t)LONG_MAX) return -1;  // Offset cannot be represented
+  if (fseek(nf->f, (long)pos, SEEK_SET) != 0) return -1;
+#endif
+  nf->blockPos  = pos;
+  nf->pBlock    = nf->pBuf; // Empty block (next byte will fill it)
+  nf->pCur      = nf->pBuf;
+  nf->pEnd      = nf->pBuf;
+  return 0; // OK
+}
+
+// Open a view of mapped file 'nf' starting at 'pos' (used by decoder threads).
+// View does not own the mapping (closing it does nothing to 'nf').
+int NexRvFile_View(NexRvFile *v, const NexRvFile *nf, uint64_t pos)
+{
+  if (nf->pMap == NULL || pos > nf->mapSize) return -1;  // Only mapped file can be shared
+
+  v->f        = nf->f;
+  v->blockPos = pos;
+  v->pBuf     = NULL;
+  v->pMap     = NULL;
+  v->mapSize  = 0;
+  v->pBlock   = (const unsigned char *)nf->pMap + pos;
+  v->pCur     = v->pBlock;
+  v->pEnd     = (const unsigned char *)nf->pMap + nf->mapSize;
+  return 0; // OK
+}
+
+void NexRvFile_Close(NexRvFile *nf)
+{
+#if NEXRV_MMAP
+  if (nf->pMap != NULL) munmap(nf->pMap, (size_t)nf->mapSize);
+#endif
+  nf->pMap = NULL;
+  if (nf->pBuf != NULL) free(nf->pBuf);
+  nf->pBuf = NULL;
+  nf->pBlock = nf->pCur = nf->pEnd = NULL;
+}
+
+// Elapsed time in seconds (for MB/s statistics)
+double NexRvFile_Seconds(void)
+{
+#if NEXRV_MMAP && defined(_POSIX_TIMERS) && (_POSIX_TIMERS > 0)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+  {
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+  }
+#endif
+  return ((double)clock()) / CLOCKS_PER_SEC;
+}
+
+//****************************************************************************
+// End of NexRvFile.c file
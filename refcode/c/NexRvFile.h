@@ -0,0 +1,61 @@
+/*
+* Copyright (c) 2020 IAR Systems AB.
+*
+* Permission to use, copy, modify, and distribute this software for any
+* purpose with or without fee is hereby granted, provided that the above
+* copyright notice and this permission notice appear in all copies.
+*
+* THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+* WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+* ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+* WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+* ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+* OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//****************************************************************************
+// File NexRvFile.h  - Nexus file input (memory-mapped or block-buffered)
+
+// Dump and decoder do not read Nexus file byte-by-byte (with 'fread').
+// File is memory-mapped (if possible) or it is read in big blocks and
+// bytes are taken from a pointer (see NEXRV_FILE_GET below).
+
+#ifndef NEXRVFILE_H
+#define NEXRVFILE_H
+
+#include <stdio.h>  // For FILE
+#include <stdint.h> // For uint64_t
+
+#define NEXRV_FILE_BLOCK  0x100000  // Size of block (when file is not mapped)
+
+typedef struct NEXRV_FILE
+{
+  FILE                *f;         // File to read from
+  const unsigned char *pBlock;    // First byte of current block
+  const unsigned char *pCur;      // Next byte to be taken
+  const unsigned char *pEnd;      // End of current block
+  uint64_t            blockPos;   // File offset of 'pBlock'
+  unsigned char       *pBuf;      // Block buffer (NULL if file is mapped)
+  void                *pMap;      // Mapped file (NULL if file is not mapped)
+  uint64_t            mapSize;    // Size of mapped file
+} NexRvFile;
+
+extern int      NexRvFile_Open(NexRvFile *nf, FILE *f);
+extern int      NexRvFile_Fill(NexRvFile *nf);
+extern int      NexRvFile_Seek(NexRvFile *nf, uint64_t pos);
+extern int      NexRvFile_View(NexRvFile *v, const NexRvFile *nf, uint64_t pos);
+extern void     NexRvFile_Close(NexRvFile *nf);
+extern double   NexRvFile_Seconds(void);
+
+// Get next byte to 'b' (evaluates to 0 at EOF)
+#define NEXRV_FILE_GET(nf, b) \
+  (((nf)->pCur < (nf)->pEnd || NexRvFile_Fill(nf) > 0) ? ((b) = *(nf)->pCur++, 1) : 0)
+
+// File offset of next byte
+#define NEXRV_FILE_POS(nf)  ((nf)->blockPos + (uint64_t)((nf)->pCur - (nf)->pBlock))
+
+#endif  // NEXRVFILE_H
+
+//****************************************************************************
+// End of NexRvFile.h file
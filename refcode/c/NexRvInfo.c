@@ -24,7 +24,7 @@
 //  3. Only non K&R C is 'for (int x' and 'int x;' between instructions.
 
 #include <stdio.h>  //  For NULL, 'printf', 'fopen, ...'
-#include <stdlib.h> //  For 'malloc', 'free'
+#include <stdlib.h> //  For 'malloc', 'free', 'qsort'
 #include <string.h> //  For 'strcmp', 'strchr' 
 #include <ctype.h>  //  For 'isspace/isxdigit' etc.
 #include <inttypes.h>   //  For scan formats SCNx64
@@ -33,9 +33,6 @@
 
 // int InfoParse(const char *t, InfoAddr *pAddr, unsigned int *pInfo, InfoAddr *pDest);
 
-static FILE *fInfo = NULL;     // Instruction info (text-based records)
-static InfoAddr prevAddr = 0xFFFFFFFF;
-
 typedef struct INFO_REC
 {
   InfoAddr addr;          // Address of instruction
@@ -44,108 +41,508 @@ typedef struct INFO_REC
   unsigned int _padding;  // Make it 64-bit aligned
 } INFO_REC;
 
-typedef struct INFO_ADDR
+typedef struct INFO_LIN
 {
-  unsigned int  info;     // INFO for this instruction
-  InfoAddr      dest;     // Destination address
-} INFO_ADDR;
+  unsigned int  nLin;     // Number of linear instructions from this record
+  unsigned int  nHW;      // Number of 16-bit units of these instructions
+} INFO_LIN;
+
+typedef struct INFO_SYM
+{
+  InfoAddr addr;          // Address of symbol (function start)
+  char     *name;
+} INFO_SYM;
 
+// Records and symbols of all code images are in one table (records and
+// symbols of each image are consecutive), so indexes of records and symbols
+// are the same for all images (see InfoRecImage/InfoSymImage).
 static int nInfoRec = 0;
-static int infoLast = 0;
-static INFO_REC *pInfoRec   = NULL;
+static INFO_REC *pInfoRec   = NULL;   // All records (sorted by address in each image)
+static INFO_LIN *pInfoLin   = NULL;   // Basic-block table (one for each record)
 
-InfoAddr infoAddr_min = 0;
-InfoAddr infoAddr_max = 0;
-static INFO_ADDR *pInfoAddr  = NULL;
+static int nInfoSym = 0;
+static int capInfoSym = 0;
+static INFO_SYM *pInfoSym   = NULL;   // All symbols (sorted by address in each image)
 
-int InfoInit(const char *filename)
+static int infoSave = 0;              // Records and symbols are saved (not only counted)
+
+// Multi-level page table (keyed by 16-bit unit address, so 'addr >> 1').
+// Only pages with some code are allocated, so memory is proportional to
+// code size (and not to span of addresses). Lookup is always O(1):
+//  INFO_DIR_LEVELS directories with (1 << INFO_DIR_BITS) pointers and a
+//  page with (1 << INFO_PAGE_BITS) record indexes (+1, so 0 means none).
+#define INFO_PAGE_BITS  12    // 4096 16-bit units (8KB of code) per page
+#define INFO_DIR_BITS   13    // 8192 entries per directory
+#define INFO_DIR_LEVELS 4     // 12 + 4 * 13 >= 63 bits of 16-bit unit address
+
+static int  nInfoPages = 0;   // Number of allocated pages (and directories)
+
+#define INFO_MAP_MAX    256   // Max number of images of load-map file
+
+static void InfoFree(void);
+
+// Code images of processes (PROCESS field of Ownership message). Each image
+// has its own page table (PC ranges of processes may overlap). Image #0 is
+// the one of InfoInit (used for processes without own image and for NULL).
+#define INFO_IMAGE_MAX  (INFO_PROCESS_MAX + 1)  // Max number of images (with image #0)
+#define INFO_HASH_SIZE  512   // Process to image hash (power of 2, > INFO_IMAGE_MAX)
+
+struct INFO_IMAGE
 {
-  prevAddr = 0xFFFFFFFF;
-  fInfo = fopen(filename, "rt");
-  if (fInfo == NULL) return -1; // Failed
+  void      *pTop;      // Top-level directory of page table (or NULL)
+  int       recBase;    // First record of image
+  int       nRec;
+  int       symBase;    // First symbol of image
+  int       nSym;
+};
+
+static InfoImage  infoImage[INFO_IMAGE_MAX];
+static int        nInfoImage = 1;   // Number of images (#0 is always there)
+static uint64_t   infoHashKey[INFO_HASH_SIZE];  // Process
+static int        infoHashVal[INFO_HASH_SIZE];  // Image of process (0 if empty)
+
+// Slot of 'process' in hash (it is empty if process has no image)
+static int InfoHashSlot(uint64_t process)
+{
+  unsigned int h = (unsigned int)((process * 0x9E3779B97F4A7C15ull) >> 40) & (INFO_HASH_SIZE - 1);
+  while (infoHashVal[h] != 0 && infoHashKey[h] != process) h = (h + 1) & (INFO_HASH_SIZE - 1);
+  return h;
+}
 
-  nInfoRec = 0;
-  while (pInfoRec == NULL)      // Will run twice
+static int InfoPageAdd(InfoImage *img, InfoAddr addr, int rec)
+{
+  InfoAddr hw = addr >> 1;
+  void **pp = &img->pTop;
+  for (int l = INFO_DIR_LEVELS; l > 0; l--)
   {
-    if (nInfoRec > 0) // Allocate (second time ...)
+    if (*pp == NULL)
     {
-      pInfoRec = malloc(sizeof(INFO_REC) * nInfoRec);
+      *pp = calloc(((size_t)1) << INFO_DIR_BITS, sizeof(void *));
+      if (*pp == NULL) return -1;
+      nInfoPages++;
     }
+    unsigned int i = (unsigned int)(hw >> (INFO_PAGE_BITS + (l - 1) * INFO_DIR_BITS)) & ((1u << INFO_DIR_BITS) - 1);
+    pp = &((void **)*pp)[i];
+  }
+  if (*pp == NULL)
+  {
+    *pp = calloc(((size_t)1) << INFO_PAGE_BITS, sizeof(int));
+    if (*pp == NULL) return -1;
+    nInfoPages++;
+  }
+  ((int *)*pp)[hw & ((1u << INFO_PAGE_BITS) - 1)] = rec + 1;
+  return 0;
+}
 
-    nInfoRec = 0;
-    fseek(fInfo, 0, SEEK_SET); // Rewind file
-    char line[1000];
-    while (fgets(line, sizeof(line), fInfo) != NULL)
+static void InfoPageFree(void *p, int l)
+{
+  if (p == NULL) return;
+  if (l > 0)
+  {
+    for (unsigned int i = 0; i < (1u << INFO_DIR_BITS); i++)
     {
-      if (line[0] == '.' && line[1] == 'e') break; // End
-      if (line[0] == '.') continue; // Comment (ignore this line)
-      if (line[0] == '\0' || line[0] == '\n') continue; // Ignore empty as well ...
+      InfoPageFree(((void **)p)[i], l - 1);
+    }
+  }
+  free(p);
+}
 
-      InfoAddr a, dest;
-      unsigned int info;
-      if (!InfoParse(line, &a, &info, &dest)) break;
-      if (info == 0) break;
+static int InfoRecCompare(const void *p1, const void *p2)
+{
+  InfoAddr a1 = ((const INFO_REC *)p1)->addr;
+  InfoAddr a2 = ((const INFO_REC *)p2)->addr;
+  return (a1 < a2) ? -1 : (a1 > a2) ? 1 : 0;
+}
 
-      if (pInfoRec != NULL)
-      {
-        pInfoRec[nInfoRec].addr = a;
-        pInfoRec[nInfoRec].info = info;
-        pInfoRec[nInfoRec].dest = dest;
-        pInfoRec[nInfoRec]._padding = 0;
-      }
+static int InfoSymCompare(const void *p1, const void *p2)
+{
+  InfoAddr a1 = ((const INFO_SYM *)p1)->addr;
+  InfoAddr a2 = ((const INFO_SYM *)p2)->addr;
+  return (a1 < a2) ? -1 : (a1 > a2) ? 1 : 0;
+}
+
+// Add symbol from '<addr> <name>' text (after '.sym '), image is loaded at 'offset'
+static int InfoSymAdd(const char *t, InfoAddr offset)
+{
+  InfoAddr a;
+  if (sscanf(t, "%" SCNx64, &a) != 1) return 0; // Ignore it
+  a += offset;
 
-      nInfoRec++;
+  while (*t != '\0' && !isspace(*t)) t++;
+  while (*t == ' ' || *t == '\t') t++;
+  size_t len = strlen(t);
+  while (len > 0 && isspace(t[len - 1])) len--;
+  if (len == 0) return 0;
+
+  if (nInfoSym >= capInfoSym)
+  {
+    int cap = (capInfoSym == 0) ? 256 : 2 * capInfoSym;
+    INFO_SYM *p = realloc(pInfoSym, cap * sizeof(INFO_SYM));
+    if (p == NULL) return -1;
+    pInfoSym = p;
+    capInfoSym = cap;
+  }
+  char *name = malloc(len + 1);
+  if (name == NULL) return -1;
+  memcpy(name, t, len);
+  name[len] = '\0';
+
+  pInfoSym[nInfoSym].addr = a;
+  pInfoSym[nInfoSym].name = name;
+  nInfoSym++;
+  return 1;
+}
+
+// Read records of PCINFO file (image loaded at 'offset') to 'pInfoRec' from
+// 'nInfoRec' (only count them if 'infoSave' is 0). Symbols are read only
+// when records are saved.
+static int InfoReadFile(FILE *fInfo, InfoAddr offset)
+{
+  fseek(fInfo, 0, SEEK_SET); // Rewind file
+  char line[1000];
+  while (fgets(line, sizeof(line), fInfo) != NULL)
+  {
+    if (line[0] == '.' && line[1] == 'e') break; // End
+    if (strncmp(line, ".sym ", 5) == 0)
+    {
+      if (infoSave && InfoSymAdd(line + 5, offset) < 0) return -1;
+      continue;
     }
+    if (line[0] == '.') continue; // Comment (ignore this line)
+    if (line[0] == '\0' || line[0] == '\n') continue; // Ignore empty as well ...
+
+    InfoAddr a, dest = 0;
+    unsigned int info;
+    if (!InfoParse(line, &a, &info, &dest)) break;
+    if (info == 0) break;
 
-    if (nInfoRec == 0)
+    if (infoSave)
     {
-      break;  // No records
+      pInfoRec[nInfoRec].addr = a + offset;
+      pInfoRec[nInfoRec].info = info;
+      pInfoRec[nInfoRec].dest = ((info & (INFO_BRANCH | INFO_JUMP)) && (!(info & INFO_INDIRECT) || (info & INFO_SEQJUMP))) ? dest + offset : dest;
+      pInfoRec[nInfoRec]._padding = 0;
     }
+
+    nInfoRec++;
   }
+  return 0;
+}
 
-#if 1 // Generate table with all INFO for all addresses
-  if (pInfoRec != NULL)
+// Read all images of load-map file (see NexRvInfo.h). Names of PCINFO files
+// are relative to directory of load-map file (unless these are absolute).
+// Address ranges of images (after relocation) must not overlap.
+static int InfoReadMap(FILE *fMap, const char *mapName, int disp)
+{
+  InfoAddr rng[INFO_MAP_MAX][2];  // [lo,hi) of each image (when records are saved)
+  char rngName[INFO_MAP_MAX][64];
+  int nRng = 0;
+
+  size_t dirLen = 0;
+  for (size_t i = 0; mapName[i] != '\0'; i++)
   {
-    // Get span of addresses ...
-    infoAddr_min = pInfoRec[0].addr;
-    infoAddr_max = pInfoRec[nInfoRec - 1].addr;
+    if (mapName[i] == '/' || mapName[i] == '\\') dirLen = i + 1;
+  }
 
-    if ((infoAddr_max - infoAddr_min) <= 3 * (nInfoRec * 4))
+  fseek(fMap, 0, SEEK_SET);
+  char line[1000];
+  while (fgets(line, sizeof(line), fMap) != NULL)
+  {
+    if (line[0] == '.' && line[1] == 'e') break; // End
+    if (line[0] == '.') continue; // Comment (and '.loadmap' header)
+
+    char name[256], file[512];
+    char offs[64];
+    if (sscanf(line, "%255s %63s %511s", name, offs, file) != 3) continue; // Empty line (or not valid)
+
+    char *e;
+    InfoAddr offset = (InfoAddr)strtoull(offs, &e, 0);
+    if (*e != '\0')
     {
-      printf("NexRv/Info: amin=0x%lX, amax=0x%lX, nRec=%d\n", infoAddr_min, infoAddr_max, nInfoRec);
+      printf("ERROR: Load offset of image %s is not valid\n", name);
+      return -1;
+    }
 
-      // This is not so big (not more than 3x bigger than original)
-      pInfoAddr = malloc(sizeof(INFO_ADDR) * (infoAddr_max - infoAddr_min + 1));
+    char path[1024];
+    if (file[0] == '/' || file[0] == '\\' || strchr(file, ':') != NULL || dirLen + strlen(file) >= sizeof(path))
+    {
+      snprintf(path, sizeof(path), "%s", file);
+    }
+    else
+    {
+      memcpy(path, mapName, dirLen);
+      strcpy(path + dirLen, file);
+    }
 
-      for (int a = 0; a < (infoAddr_max - infoAddr_min + 1); a++)
+    FILE *fInfo = fopen(path, "rt");
+    if (fInfo == NULL)
+    {
+      printf("ERROR: Cannot open PCINFO file %s of image %s\n", path, name);
+      return -1;
+    }
+    int n = nInfoRec;
+    int nSym = nInfoSym;
+    int ret = InfoReadFile(fInfo, offset);
+    fclose(fInfo);
+    if (ret < 0) return ret;
+    if (infoSave && nInfoSym == nSym && nInfoRec > n)
+    {
+      // Image without symbols - its name is the symbol (at lowest address),
+      // so code of image is not counted to last function of other image
+      InfoAddr lo = pInfoRec[n].addr;
+      for (int i = n + 1; i < nInfoRec; i++)
       {
-        pInfoAddr[a].info = 0;
-        pInfoAddr[a].dest = 0;
+        if (pInfoRec[i].addr < lo) lo = pInfoRec[i].addr;
       }
+      snprintf(line, sizeof(line), "%lX %s", lo, name);
+      if (InfoSymAdd(line, 0) < 0) return -1;
+    }
+    if (infoSave && nInfoRec > n)
+    {
+      InfoAddr lo = pInfoRec[n].addr, hi = lo;
+      for (int i = n; i < nInfoRec; i++)
+      {
+        InfoAddr end = pInfoRec[i].addr + ((pInfoRec[i].info & INFO_4) ? 4 : 2);
+        if (pInfoRec[i].addr < lo) lo = pInfoRec[i].addr;
+        if (end > hi) hi = end;
+      }
+      for (int k = 0; k < nRng; k++)
+      {
+        if (lo < rng[k][1] && rng[k][0] < hi)
+        {
+          printf("ERROR: Image %s (0x%lX..0x%lX) overlaps image %s (0x%lX..0x%lX)\n",
+                 name, lo, hi - 1, rngName[k], rng[k][0], rng[k][1] - 1);
+          return -1;
+        }
+      }
+      if (nRng >= INFO_MAP_MAX)
+      {
+        printf("ERROR: Too many images in load-map (max %d)\n", INFO_MAP_MAX);
+        return -1;
+      }
+      rng[nRng][0] = lo;
+      rng[nRng][1] = hi;
+      snprintf(rngName[nRng], sizeof(rngName[nRng]), "%s", name);
+      nRng++;
+    }
+    if (disp) printf("NexRv/Info: image %s at offset 0x%lX, nRec=%d\n", name, offset, nInfoRec - n);
+  }
+  return 0;
+}
+
+// Read PCINFO (or load-map) file to 'img' (after records and symbols of
+// previous images). Caller frees records of image on error (see InfoDrop).
+static int InfoLoad(InfoImage *img, const char *filename)
+{
+  FILE *fInfo = fopen(filename, "rt");
+  if (fInfo == NULL) return -1; // Failed
+
+  // Load-map file (many images) or PCINFO file (one image at its addresses)
+  char line[1000];
+  int map = (fgets(line, sizeof(line), fInfo) != NULL && strncmp(line, ".loadmap", 8) == 0);
+
+  img->recBase = nInfoRec;
+  img->symBase = nInfoSym;
+  int ret = 0;
+  for (infoSave = 0; infoSave < 2 && ret >= 0; infoSave++)  // Will run twice
+  {
+    if (infoSave) // Allocate (second time ...)
+    {
+      if (nInfoRec == img->recBase) break;  // No records
+      INFO_REC *p = realloc(pInfoRec, sizeof(INFO_REC) * nInfoRec);
+      if (p == NULL) { ret = -1; break; }
+      pInfoRec = p;
+    }
+
+    nInfoRec = img->recBase;
+    ret = map ? InfoReadMap(fInfo, filename, infoSave) : InfoReadFile(fInfo, 0);
+  }
+  infoSave = 0;
+  fclose(fInfo);
+  img->nRec = nInfoRec - img->recBase;
+  img->nSym = nInfoSym - img->symBase;
+  if (ret < 0) return -1;
 
-      for (int i = 0; i < nInfoRec; i++)
+  if (img->nRec == 0)
+  {
+    return 0; // OK (but no records, so InfoGet will always fail)
+  }
+
+  // Records may be in any order (sections of objdump), so sort them
+  INFO_REC *rec = pInfoRec + img->recBase;
+  qsort(rec, img->nRec, sizeof(INFO_REC), InfoRecCompare);
+  if (img->nSym > 0)
+  {
+    // Sort symbols and keep only one of these at the same address
+    INFO_SYM *sym = pInfoSym + img->symBase;
+    qsort(sym, img->nSym, sizeof(INFO_SYM), InfoSymCompare);
+    int n = 1;
+    for (int i = 1; i < img->nSym; i++)
+    {
+      if (sym[i].addr == sym[n - 1].addr)
       {
-        pInfoAddr[pInfoRec[i].addr - infoAddr_min].info = pInfoRec[i].info;
-        pInfoAddr[pInfoRec[i].addr - infoAddr_min].dest = pInfoRec[i].dest;
+        free(sym[i].name);
+        continue;
       }
+      sym[n++] = sym[i];
+    }
+    img->nSym = n;
+    nInfoSym  = img->symBase + n;
+  }
+
+  // Build page table
+  for (int i = img->recBase; i < nInfoRec; i++)
+  {
+    if (InfoPageAdd(img, pInfoRec[i].addr, i) < 0) return -1;
+  }
+
+  printf("NexRv/Info: amin=0x%lX, amax=0x%lX, nRec=%d", rec[0].addr, rec[img->nRec - 1].addr, img->nRec);
+  if (img->nSym > 0) printf(", nSym=%d", img->nSym);
+  printf("\n");
+
+#if 1 // Generate basic-block table (linear instructions up to next control-flow instruction)
+  INFO_LIN *lin = realloc(pInfoLin, sizeof(INFO_LIN) * nInfoRec);
+  if (lin == NULL) return -1;
+  pInfoLin = lin;
+
+  // Go backward, so each linear run is extended by run which is following it
+  for (int i = nInfoRec - 1; i >= img->recBase; i--)
+  {
+    unsigned int info = pInfoRec[i].info;
+    if (info & ~(INFO_LINEAR | INFO_4))
+    {
+      pInfoLin[i].nLin = 0; // Control-flow instruction terminates block
+      pInfoLin[i].nHW  = 0;
+      continue;
+    }
+
+    unsigned int size = (info & INFO_4) ? 2 : 1;
+    pInfoLin[i].nLin = 1;
+    pInfoLin[i].nHW  = size;
+    if (i + 1 < nInfoRec && pInfoRec[i + 1].addr == pInfoRec[i].addr + 2 * size)
+    {
+      // Next record is at next address (so it is the same block)
+      pInfoLin[i].nLin += pInfoLin[i + 1].nLin;
+      pInfoLin[i].nHW  += pInfoLin[i + 1].nHW;
     }
   }
 #endif
 
-  infoLast = 0;
   return 0; // OK
 }
 
-void InfoTerm(void)
+// Free page table, records and symbols of 'img' (it is the last image)
+static void InfoDrop(InfoImage *img)
+{
+  InfoPageFree(img->pTop, INFO_DIR_LEVELS);
+  img->pTop = NULL;
+  for (int i = img->symBase; i < nInfoSym; i++)
+  {
+    free(pInfoSym[i].name);
+  }
+  nInfoSym  = img->symBase;
+  nInfoRec  = img->recBase;
+  img->nRec = 0;
+  img->nSym = 0;
+}
+
+int InfoInit(const char *filename)
+{
+  memset(&infoImage[0], 0, sizeof(InfoImage));
+  nInfoImage = 1;
+  if (InfoLoad(&infoImage[0], filename) < 0)
+  {
+    InfoFree();   // Records (and symbols) read so far
+    return -1;
+  }
+  return 0;
+}
+
+static void InfoFree(void)
 {
-  if (fInfo != NULL) fclose(fInfo);
-  fInfo = NULL;
+  for (int k = 0; k < nInfoImage; k++)
+  {
+    InfoPageFree(infoImage[k].pTop, INFO_DIR_LEVELS);
+  }
+  memset(infoImage, 0, sizeof(infoImage));
+  nInfoImage = 1;
+  nInfoPages = 0;
   if (pInfoRec) free(pInfoRec);
   pInfoRec = NULL;
-  if (pInfoAddr) free(pInfoAddr);
-  pInfoAddr = NULL;
+  if (pInfoLin) free(pInfoLin);
+  pInfoLin = NULL;
   nInfoRec = 0;
-  infoLast = 0;
+  for (int i = 0; i < nInfoSym; i++)
+  {
+    free(pInfoSym[i].name);
+  }
+  if (pInfoSym) free(pInfoSym);
+  pInfoSym = NULL;
+  nInfoSym = 0;
+  capInfoSym = 0;
+}
+
+void InfoTerm(void)
+{
+  InfoFree();
+  memset(infoHashVal, 0, sizeof(infoHashVal));
+}
+
+// Load PCINFO file as code image of 'process' (see InfoProcessImage)
+int InfoProcessAdd(uint64_t process, const char *filename)
+{
+  int h = InfoHashSlot(process);
+  if (infoHashVal[h] != 0 || nInfoImage >= INFO_IMAGE_MAX) return -1;  // Duplicate or too many
+
+  InfoImage *img = &infoImage[nInfoImage];
+  memset(img, 0, sizeof(InfoImage));
+  if (InfoLoad(img, filename) < 0)
+  {
+    InfoDrop(img);
+    return -1;
+  }
+
+  infoHashKey[h] = process;
+  infoHashVal[h] = nInfoImage++;
+  return 0;
+}
+
+int InfoProcessCount(void)
+{
+  return nInfoImage - 1;
+}
+
+// Code image of 'process' (NULL, so image of InfoInit, if it has none)
+const InfoImage *InfoProcessImage(uint64_t process)
+{
+  int k = infoHashVal[InfoHashSlot(process)];
+  return (k == 0) ? NULL : &infoImage[k];
+}
+
+// Code image of record 'rec' (NULL is image of InfoInit, images are in order of records)
+const InfoImage *InfoRecImage(int rec)
+{
+  int lo = 0;
+  int hi = nInfoImage;  // Find last image with recBase <= rec
+  while (lo + 1 < hi)
+  {
+    int m = (lo + hi) / 2;
+    if (infoImage[m].recBase <= rec) lo = m; else hi = m;
+  }
+  return (lo == 0) ? NULL : &infoImage[lo];
+}
+
+// Code image of symbol 'sym'
+const InfoImage *InfoSymImage(int sym)
+{
+  int lo = 0;
+  int hi = nInfoImage;  // Find last image with symBase <= sym
+  while (lo + 1 < hi)
+  {
+    int m = (lo + hi) / 2;
+    if (infoImage[m].symBase <= sym) lo = m; else hi = m;
+  }
+  return (lo == 0) ? NULL : &infoImage[lo];
 }
 
 int InfoParse(const char *t, InfoAddr *pAddr, unsigned int *pInfo, InfoAddr *pDest)
@@ -168,6 +565,7 @@ int InfoParse(const char *t, InfoAddr *pAddr, unsigned int *pInfo, InfoAddr *pDe
 
   if (t[1] == 'N')  info |= INFO_LINEAR;    // Non-executed (only BN)
   if (t[1] == 'I')  info |= INFO_INDIRECT;
+  if (t[1] == 'S')  info |= INFO_INDIRECT | INFO_SEQJUMP;  // Sequential jump (with dest)
   if (t[1] == '4')  info |= INFO_4;
   if (t[2] == '4')  info |= INFO_4;
 
@@ -181,71 +579,99 @@ int InfoParse(const char *t, InfoAddr *pAddr, unsigned int *pInfo, InfoAddr *pDe
   return 3;
 }
 
-unsigned int InfoGet(InfoAddr addr, InfoAddr *pDest)
+// Find index of record for 'addr' in 'img' (or -1)
+static int InfoFind(const InfoImage *img, InfoAddr addr)
 {
-  if (pInfoAddr != NULL)
+  InfoAddr hw = addr >> 1;
+  const void *p = img->pTop;
+  for (int l = INFO_DIR_LEVELS; l > 0 && p != NULL; l--)
   {
-    if (addr < infoAddr_min || addr > infoAddr_max)
-    {
-      return 0; // Incorrect address (no INFO)
-    }
-    *pDest = pInfoAddr[addr - infoAddr_min].dest;
-    return pInfoAddr[addr - infoAddr_min].info;
+    unsigned int i = (unsigned int)(hw >> (INFO_PAGE_BITS + (l - 1) * INFO_DIR_BITS)) & ((1u << INFO_DIR_BITS) - 1);
+    p = ((void * const *)p)[i];
   }
+  if (p == NULL || (addr & 1)) return -1;
 
-  if (pInfoRec != NULL)
-  {
-    if (addr < pInfoRec[infoLast].addr)
-    {
-      // Look before ...
-      for (int i = infoLast - 1; i >= 0; --i)
-      {
-        if (pInfoRec[i].addr == addr)
-        {
-          infoLast = i;
-          if (pDest) *pDest = pInfoRec[i].dest;
-          return pInfoRec[i].info;
-        }
-      }
-    }
-    else
-    {
-      // Look after ...
-      for (int i = infoLast; i < nInfoRec; ++i)
-      {
-        if (pInfoRec[i].addr == addr)
-        {
-          infoLast = i;
-          if (pDest) *pDest = pInfoRec[i].dest;
-          return pInfoRec[i].info;
-        }
-      }
-    }
+  return ((const int *)p)[hw & ((1u << INFO_PAGE_BITS) - 1)] - 1;
+}
 
-    return 0; // Not found ...
-  }
+unsigned int InfoGet(const InfoImage *img, InfoAddr addr, InfoAddr *pDest)
+{
+  if (img == NULL) img = &infoImage[0];
+  int r = InfoFind(img, addr);
+  if (r < 0) return 0; // Error (=0)
+
+  if (pDest) *pDest = pInfoRec[r].dest;
+  return pInfoRec[r].info;
+}
 
-  if (fInfo != NULL)
+// Get basic-block which starts at 'addr' (returns 0 if not known)
+int InfoBlockGet(const InfoImage *img, InfoAddr addr, INFO_BLOCK *pBlock)
+{
+  if (pInfoLin == NULL) return 0;
+
+  if (img == NULL) img = &infoImage[0];
+  int r = InfoFind(img, addr);
+  if (r < 0) return 0;
+
+  pBlock->addr = addr;
+  pBlock->nLin = pInfoLin[r].nLin;
+  pBlock->nHW  = pInfoLin[r].nHW;
+  pBlock->rec  = r;
+  pBlock->term = addr + 2 * pInfoLin[r].nHW;
+  pBlock->info = 0;
+  pBlock->dest = 0;
+
+  int t = r + pInfoLin[r].nLin;
+  if (t < img->recBase + img->nRec && pInfoRec[t].addr == pBlock->term)
   {
-    if (addr <= prevAddr) fseek(fInfo, 0, SEEK_SET); // Rewind file (if not forward)
-    prevAddr = addr;  // Save for next call (to avoid 'fseek')
+    pBlock->info = pInfoRec[t].info;
+    pBlock->dest = pInfoRec[t].dest;
+  }
+  return 1;
+}
 
-    char line[1000];
-    while (fgets(line, sizeof(line), fInfo) != NULL)
-    {
-      if (line[0] == '.' && line[1] == 'e') break; // End
-      if (line[0] == '.') continue; // Comment (ignore this line)
-      if (line[0] == '\0' || line[0] == '\n') continue; // Ignore empty as well ...
-
-      InfoAddr a;
-      unsigned int info;
-      if (!InfoParse(line, &a, &info, pDest)) break;
-      if (info == 0) break;
-      if (a == addr) return info; // Found
-    }
-    prevAddr = 0xFFFFFFFF;
+// Get address and INFO of record (records of a block are consecutive)
+unsigned int InfoRecGet(int rec, InfoAddr *pAddr)
+{
+  *pAddr = pInfoRec[rec].addr;
+  return pInfoRec[rec].info;
+}
+
+int InfoRecCount(void)
+{
+  return nInfoRec;
+}
+
+// Index of record for 'addr' in 'img' (or -1)
+int InfoRecFind(const InfoImage *img, InfoAddr addr)
+{
+  if (img == NULL) img = &infoImage[0];
+  return InfoFind(img, addr);
+}
+
+int InfoSymCount(void)
+{
+  return nInfoSym;
+}
+
+// Index of symbol (function) of 'img', which contains 'addr' (or -1)
+int InfoSymFind(const InfoImage *img, InfoAddr addr)
+{
+  if (img == NULL) img = &infoImage[0];
+  int lo = img->symBase;
+  int hi = img->symBase + img->nSym;  // Find last symbol with address <= addr
+  while (lo < hi)
+  {
+    int m = (lo + hi) / 2;
+    if (pInfoSym[m].addr <= addr) lo = m + 1; else hi = m;
   }
-  return 0; // Error (=0)
+  return (lo > img->symBase) ? lo - 1 : -1;
+}
+
+const char *InfoSymGet(int sym, InfoAddr *pAddr)
+{
+  if (pAddr) *pAddr = pInfoSym[sym].addr;
+  return pInfoSym[sym].name;
 }
 
 //****************************************************************************
@@ -30,14 +30,58 @@
 #define INFO_JUMP     0x20  // Direct or indirect
 #define INFO_CALL     0x40  // Direct or indirect (and always a jump)
 #define INFO_RET      0x80  // Return (always indirect and always a jump)
+#define INFO_SEQJUMP  0x100 // Indirect JUMP/CALL right after LUI/AUIPC of its register (dest is known, see -seqjump)
 
 typedef uint64_t InfoAddr;
 
+typedef struct INFO_IMAGE InfoImage;  // Code image (of InfoInit or of process)
+
+// Basic-block (linear run of instructions up to next control-flow instruction)
+typedef struct INFO_BLOCK
+{
+  InfoAddr      addr;     // Address of first instruction
+  unsigned int  nLin;     // Number of linear instructions (before terminator)
+  unsigned int  nHW;      // Number of 16-bit units of these linear instructions
+  int           rec;      // Index of first record (see InfoRecGet)
+  InfoAddr      term;     // Address of terminator (addr + 2 * nHW)
+  unsigned int  info;     // INFO of terminator (0 if it is not known)
+  InfoAddr      dest;     // Destination of terminator (if direct)
+} INFO_BLOCK;
+
+// InfoInit reads PCINFO file or load-map file. Load-map file starts with
+// '.loadmap' line and it has '<image> <offset> <pcinfo>' line for each image
+// (bootloader, kernel, shared library, ...). Addresses of <pcinfo> are moved
+// by <offset> (so relocated image does not need new PCINFO file). All images
+// are in one table (images must not overlap), so lookup is not slower.
+// Lookups by address are in code image 'img' (NULL is image of InfoInit).
 extern int InfoParse(const char *t, InfoAddr *pAddr, uint32_t *pInfo, InfoAddr *pDest);
 extern int InfoInit(const char *filename);
-extern unsigned int InfoGet(InfoAddr addr, InfoAddr *pDest);
+extern unsigned int InfoGet(const InfoImage *img, InfoAddr addr, InfoAddr *pDest);
+extern int InfoBlockGet(const InfoImage *img, InfoAddr addr, INFO_BLOCK *pBlock);
+extern unsigned int InfoRecGet(int rec, InfoAddr *pAddr);
+extern int InfoRecCount(void);
+extern int InfoRecFind(const InfoImage *img, InfoAddr addr);
+
+// Symbols (function starts) from '.sym <addr> <name>' lines of PCINFO file.
+// Function extends till next symbol (of the same image).
+extern int InfoSymCount(void);
+extern int InfoSymFind(const InfoImage *img, InfoAddr addr);
+extern const char *InfoSymGet(int sym, InfoAddr *pAddr);
 extern void InfoTerm(void);
 
+// Code images of processes (Ownership message). InfoInit image is used for
+// processes without own image. Records and symbols of all images are counted
+// and indexed together (InfoRecCount, InfoRecGet, ...), so bitmaps and counters
+// by record or symbol are valid for all processes. Images are read-only after
+// loading, so each decoder (thread) has its own active image.
+#define INFO_PROCESS_MAX  255   // Max number of processes with own image
+
+extern int InfoProcessAdd(uint64_t process, const char *filename);
+extern int InfoProcessCount(void);
+extern const InfoImage *InfoProcessImage(uint64_t process);
+extern const InfoImage *InfoRecImage(int rec);
+extern const InfoImage *InfoSymImage(int sym);
+
 #endif  // NEXRVINFO_H
 
 //****************************************************************************
@@ -22,25 +22,51 @@
 
 #include "NexRv.h"
 
+// Field slots. Each field of a message is saved to its own (fixed) slot,
+// so message handler can read fields by index (no name compare).
+enum NEXF_SLOT {
+  NEXF_TCODE = 0, // Must be first (slot #0 is always TCODE)
+  NEXF_SRC,
+  NEXF_SYNC,
+  NEXF_BTYPE,
+  NEXF_ETYPE,
+  NEXF_EVCODE,
+  NEXF_CDF,
+  NEXF_RCODE,
+  NEXF_CANCEL,
+  NEXF_ICNT,
+  NEXF_UADDR,
+  NEXF_FADDR,
+  NEXF_HIST,
+  NEXF_RDATA,
+  NEXF_HREPEAT,
+  NEXF_BCNT,
+  NEXF_PROCESS,
+  NEXF_PAD,
+  NEXF_TSTAMP,
+  NEXF_MAX        // Number of slots
+};
+
 // Macros to define Nexus Messages (NEXM_...)
 //  NOTE: These macros refer to 'NEXUS_TCODE_...' and 'NEXUS_FLDSIZE_...'
 //  It is also possible to NOT do it, but it provides less flexibility.
 //
-//                          name   def (marker | value)
-//#define NEXM_BEG(n, t)      {#n,    0x100 | (t)                 }
-#define NEXM_BEG(n, t)      {#n,    0x100 | (NEXUS_TCODE_##n)   } \
-                            // , NEXM_FLD_PAR(SRC) // SRC is always following TCODE
-//#define   NEXM_FLD(n, s)    {#n,    0x200 | (s)                 }
-#define   NEXM_FLD(n, s)    {#n,    0x200 | (NEXUS_FLDSIZE_##n) }
-#define   NEXM_FLD_PAR(n)   {#n,    0x200 | 0x80 | (NEXUS_PAR_SIZE_##n) }  // 0x80 means size is a parameter
-#define   NEXM_VAR(n)       {#n,    0x400                       }
-#define   NEXM_ADR(n)       {#n,    0xC00                       }
-#define NEXM_END()          {NULL,  1                           }
+//                          name   def (marker | value)               slot
+//#define NEXM_BEG(n, t)      {#n,    0x100 | (t)                 ,   NEXF_TCODE  }
+#define NEXM_BEG(n, t)      {#n,    0x100 | (NEXUS_TCODE_##n)   ,   NEXF_TCODE  } \
+                            , NEXM_FLD_PAR(SRC) // SRC is always following TCODE (0 bits if not used)
+//#define   NEXM_FLD(n, s)    {#n,    0x200 | (s)                 ,   NEXF_##n    }
+#define   NEXM_FLD(n, s)    {#n,    0x200 | (NEXUS_FLDSIZE_##n) ,   NEXF_##n    }
+#define   NEXM_FLD_PAR(n)   {#n,    0x200 | 0x80 | (NEXUS_PAR_SIZE_##n), NEXF_##n }  // 0x80 means size is a parameter
+#define   NEXM_VAR(n)       {#n,    0x400                       ,   NEXF_##n    }
+#define   NEXM_ADR(n)       {#n,    0xC00                       ,   NEXF_##n    }
+#define NEXM_END()          {NULL,  1                           ,   0           }
 
 // Definition of Nexus Messages (subset applicable to RISC-V PC trace)
 static struct NEXM_MSGDEF_STRU {
   const char *name; // Name of message/field
   int def;          // Definition of field (see NEXM_... above)
+  int fld;          // Slot of this field (see NEXF_... above)
 } nexusMsgDef[] = {
 
   NEXM_BEG(Ownership, 2),
@@ -126,9 +152,62 @@ static struct NEXM_MSGDEF_STRU {
     NEXM_VAR(TSTAMP),
   NEXM_END(),
 
-  { NULL, 0 } // End-marker ('def == 0' is not otherwise used - see NEXM_...)
+  { NULL, 0, 0 } // End-marker ('def == 0' is not otherwise used - see NEXM_...)
 };
 
+// TCODE-indexed look-up of messages (index of NEXM_BEG in 'nexusMsgDef' or -1)
+static int nexusMsgTcode[1 << NEXUS_FLDSIZE_TCODE];
+
+// TCODE-indexed mask of slots defined for message (bit #NEXF_... is set)
+static unsigned int nexusMsgSlots[1 << NEXUS_FLDSIZE_TCODE];
+
+static int nexusMsgReady = 0;   // Tables above are built
+
+// Build 'nexusMsgTcode' and 'nexusMsgSlots' tables (before parsing). Tables
+// are written by first call only (later calls return), so decoders, which
+// are already running, never see them changing. Concurrent first calls must
+// be serialized by caller (see NexRvDeco_Create).
+static void NexusMsgInit(void)
+{
+  if (nexusMsgReady) return;
+
+  int tcode[1 << NEXUS_FLDSIZE_TCODE];
+  unsigned int slots[1 << NEXUS_FLDSIZE_TCODE] = { 0 };
+  for (int t = 0; t < (1 << NEXUS_FLDSIZE_TCODE); t++)
+  {
+    tcode[t] = -1;  // Not defined for RISC-V
+  }
+  int t = 0;
+  for (int d = 0; nexusMsgDef[d].def != 0; d++)
+  {
+    if (nexusMsgDef[d].def & 0x100)
+    {
+      t = nexusMsgDef[d].def & 0xFF;
+      tcode[t] = d;
+    }
+    if (nexusMsgDef[d].name != NULL) slots[t] |= 1u << nexusMsgDef[d].fld;
+  }
+  for (t = 0; t < (1 << NEXUS_FLDSIZE_TCODE); t++)
+  {
+    nexusMsgTcode[t] = tcode[t];
+    nexusMsgSlots[t] = slots[t];
+  }
+  nexusMsgReady = 1;
+}
+
+// Index of variable field after 'fldDef' (in message with 'fields' so far).
+// Optional fields, which are not present because of preceding fixed field,
+// are skipped, so TSTAMP is not taken as HREPEAT of ResourceFull (RCODE!=2)
+// or as HIST of ProgTraceCorrelation (CDF=0).
+static int NexusMsgNextVar(int fldDef, const Nexus_TypeField *fields)
+{
+  fldDef++;
+  int slot = nexusMsgDef[fldDef].fld;
+  if (slot == NEXF_HREPEAT && fields[NEXF_TCODE] == NEXUS_TCODE_ResourceFull && fields[NEXF_RCODE] != 2) fldDef++;
+  if (slot == NEXF_HIST && fields[NEXF_TCODE] == NEXUS_TCODE_ProgTraceCorrelation && fields[NEXF_CDF] != 1) fldDef++;
+  return fldDef;
+}
+
 #endif  // NEXRVMSG_H
 
 //****************************************************************************
@@ -0,0 +1,187 @@
+/*
+* Copyright (c) 2020 IAR Systems AB.
+*
+* Permission to use, copy, modify, and distribute this software for any
+* purpose with or without fee is hereby granted, provided that the above
+* copyright notice and this permission notice appear in all copies.
+*
+* THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+* WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+* ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+* WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+* ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+* OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//****************************************************************************
+// File NexRvPcBin.c - Binary PCOUT format (writer and reader) and binary PCSEQ format (writer)
+
+// Code below is written in plain C-code.
+// It was compiled using VisualC, GNU and IAR C/C++ compiler.
+//  1. Only standard C-types are used.
+//  2. Only few standard C functions used - see notes with "#include <...>"
+//  3. Only non K&R C is 'for (int x' and 'int x;' between instructions.
+
+#include <stdio.h>  //  For 'putc', 'getc', 'fwrite', 'fread', 'fseek', 'fflush', 'ferror'
+#include <string.h> //  For 'memcmp'
+
+#include "NexRvPcBin.h"
+
+static int PutVar(FILE *f, uint64_t v)
+{
+  while (v >= 0x80)
+  {
+    if (putc((int)(v & 0x7F) | 0x80, f) == EOF) return -1;
+    v >>= 7;
+  }
+  if (putc((int)v, f) == EOF) return -1;
+  return 0;
+}
+
+static int GetVar(FILE *f, uint64_t *pV)
+{
+  uint64_t v = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+  {
+    int c = getc(f);
+    if (c == EOF) return (shift == 0) ? 0 : -1;  // EOF or truncated record
+    v |= ((uint64_t)(c & 0x7F)) << shift;
+    if ((c & 0x80) == 0)
+    {
+      *pV = v;
+      return 1;
+    }
+  }
+  return -1;  // Too long
+}
+
+// Emit pending record (if any)
+static int PcBin_Flush(NexRvPcBin *pb)
+{
+  if (pb->count == 0) return 0;
+
+  uint64_t zz = (((uint64_t)pb->delta) << 1) ^ (uint64_t)(pb->delta >> 63);  // zigzag
+  if (pb->count == 1)
+  {
+    if (PutVar(pb->f, zz << 1) < 0) return -1;
+  }
+  else
+  {
+    if (PutVar(pb->f, (zz << 1) | 1) < 0) return -1;
+    if (PutVar(pb->f, pb->count) < 0) return -1;
+  }
+  pb->count = 0;
+  return 0;
+}
+
+int PcBin_WriteOpen(NexRvPcBin *pb, FILE *f)
+{
+  pb->f     = f;
+  pb->prev  = 0;
+  pb->delta = 0;
+  pb->count = 0;
+  if (fwrite(NEXRV_PCBIN_MAGIC, 1, 8, f) != 8) return -1;
+  return 0;
+}
+
+int PcBin_Put(NexRvPcBin *pb, Nexus_TypeAddr pc)
+{
+  int64_t delta = (int64_t)(pc - pb->prev);
+  pb->prev = pc;
+
+  if (pb->count > 0 && delta == pb->delta)
+  {
+    pb->count++;  // Same step as before (just count it)
+    return 0;
+  }
+
+  if (PcBin_Flush(pb) < 0) return -1;
+  pb->delta = delta;
+  pb->count = 1;
+  return 0;
+}
+
+// Write pending record and check all writes (returns -1 if any write failed)
+int PcBin_WriteClose(NexRvPcBin *pb)
+{
+  if (PcBin_Flush(pb) < 0) return -1;
+  if (fflush(pb->f) != 0 || ferror(pb->f)) return -1;
+  return 0;
+}
+
+// Returns 1 if file is binary PCOUT (otherwise file is rewound and 0 is returned)
+int PcBin_ReadOpen(NexRvPcBin *pb, FILE *f)
+{
+  pb->f     = f;
+  pb->prev  = 0;
+  pb->delta = 0;
+  pb->count = 0;
+
+  char magic[8];
+  if (fread(magic, 1, 8, f) == 8 && memcmp(magic, NEXRV_PCBIN_MAGIC, 8) == 0)
+  {
+    return 1;
+  }
+  fseek(f, 0, SEEK_SET);
+  return 0;
+}
+
+// Get next PC (returns 1 if OK, 0 at EOF and <0 for corrupted file)
+int PcBin_Get(NexRvPcBin *pb, Nexus_TypeAddr *pPc)
+{
+  if (pb->count == 0)
+  {
+    uint64_t v;
+    int ret = GetVar(pb->f, &v);
+    if (ret <= 0) return ret;
+
+    uint64_t zz = v >> 1;
+    pb->delta = (int64_t)(zz >> 1) ^ -(int64_t)(zz & 1);  // un-zigzag
+    pb->count = 1;
+    if (v & 1)
+    {
+      if (GetVar(pb->f, &pb->count) <= 0 || pb->count == 0) return -1;
+    }
+  }
+
+  pb->count--;
+  pb->prev += (Nexus_TypeAddr)pb->delta;
+  *pPc = pb->prev;
+  return 1;
+}
+
+int PcsBin_WriteOpen(NexRvPcsBin *ps, FILE *f)
+{
+  ps->f     = f;
+  ps->next  = 0;
+  ps->cycle = 0;
+  if (fwrite(NEXRV_PCSBIN_MAGIC, 1, 8, f) != 8) return -1;
+  return 0;
+}
+
+// Write retired instruction (it has INFO of PCSEQ line)
+int PcsBin_Put(NexRvPcsBin *ps, Nexus_TypeAddr pc, unsigned int info, uint64_t cycle)
+{
+  int64_t delta = (int64_t)(pc - ps->next);
+  uint64_t zz = (((uint64_t)delta) << 1) ^ (uint64_t)(delta >> 63);  // zigzag
+  int c = (cycle != ps->cycle + 1);
+
+  if (putc((int)NEXRV_PCSBIN_INFO(info), ps->f) == EOF) return -1;
+  if (PutVar(ps->f, (zz << 1) | c) < 0) return -1;
+  if (c && PutVar(ps->f, cycle - ps->cycle) < 0) return -1;
+
+  ps->next  = pc + ((info & INFO_4) ? 4 : 2);
+  ps->cycle = cycle;
+  return 0;
+}
+
+// Write '.process <id>' record
+int PcsBin_Process(NexRvPcsBin *ps, uint64_t process)
+{
+  if (putc(0, ps->f) == EOF) return -1;
+  return PutVar(ps->f, process);
+}
+
+//****************************************************************************
+// End of NexRvPcBin.c file
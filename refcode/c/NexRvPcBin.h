@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2020 IAR Systems AB.
+*
+* Permission to use, copy, modify, and distribute this software for any
+* purpose with or without fee is hereby granted, provided that the above
+* copyright notice and this permission notice appear in all copies.
+*
+* THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+* WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+* ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+* WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+* ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+* OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//****************************************************************************
+// File NexRvPcBin.h  - Binary PCOUT format (writer and reader) and binary PCSEQ format (writer)
+
+// Binary PCOUT file is 8-byte header (NEXRV_PCBIN_MAGIC) followed by records.
+// Each record is varint (LEB128 - 7 bits per byte, bit 7 means 'more bytes'):
+//   V = (zigzag(delta) << 1) | R   - 'delta' is signed PC difference (in bytes)
+//   [N]                            - only if R=1: number of repeats (>= 2)
+// Record means 1 (or N) instructions, each at PC of previous one + 'delta'.
+// First PC is relative to 0. Typical instruction takes 1 byte (or less).
+
+// Binary PCSEQ file (encoder input, see -conv ... -pcsbin) is 8-byte header
+// (NEXRV_PCSBIN_MAGIC) followed by records of retired instructions:
+//   I                              - INFO byte (see NEXRV_PCSBIN_INFO below)
+//   V = (zigzag(delta) << 1) | C   - varint, 'delta' is PC minus PC after previous instruction
+//   [T]                            - only if C=1: cycle minus cycle of previous instruction (varint)
+// Cycle is previous cycle + 1 if C=0 (like PCSEQ line without '@<cycle>').
+// Record with INFO byte 0 is '.process <id>' line (varint <id> follows).
+// Linear instruction takes 2 bytes. Encoder reads it without any parsing.
+
+#ifndef NEXRVPCBIN_H
+#define NEXRVPCBIN_H
+
+#include <stdio.h>  // For FILE
+
+#include "NexRv.h"  // For Nexus_TypeAddr
+#include "NexRvInfo.h"  // For INFO_...
+
+#define NEXRV_PCBIN_MAGIC "NXRVPCB1"  // 8 bytes (without '\0')
+#define NEXRV_PCSBIN_MAGIC "NXRVPCS1" // 8 bytes (without '\0')
+
+// INFO byte of binary PCSEQ is INFO with INFO_SEQJUMP moved to reserved bit #2
+#define NEXRV_PCSBIN_INFO(info) (((info) & 0xFB) | (((info) & INFO_SEQJUMP) ? 0x4 : 0))
+#define NEXRV_PCSBIN_INFO_GET(b) (((b) & 0xFB) | (((b) & 0x4) ? INFO_SEQJUMP : 0))
+
+typedef struct NEXRV_PCBIN
+{
+  FILE            *f;       // File to write/read
+  Nexus_TypeAddr  prev;     // Previous PC
+  int64_t         delta;    // Delta of pending (or current) record
+  uint64_t        count;    // Number of pending (or remaining) instructions
+} NexRvPcBin;
+
+extern int  PcBin_WriteOpen(NexRvPcBin *pb, FILE *f);
+extern int  PcBin_Put(NexRvPcBin *pb, Nexus_TypeAddr pc);
+extern int  PcBin_WriteClose(NexRvPcBin *pb);
+extern int  PcBin_ReadOpen(NexRvPcBin *pb, FILE *f);
+extern int  PcBin_Get(NexRvPcBin *pb, Nexus_TypeAddr *pPc);
+
+typedef struct NEXRV_PCSBIN
+{
+  FILE            *f;       // File to write
+  Nexus_TypeAddr  next;     // PC after previous instruction
+  uint64_t        cycle;    // Cycle of previous instruction
+} NexRvPcsBin;
+
+extern int  PcsBin_WriteOpen(NexRvPcsBin *ps, FILE *f);
+extern int  PcsBin_Put(NexRvPcsBin *ps, Nexus_TypeAddr pc, unsigned int info, uint64_t cycle);
+extern int  PcsBin_Process(NexRvPcsBin *ps, uint64_t process);
+
+#endif  // NEXRVPCBIN_H
+
+//****************************************************************************
+// End of NexRvPcBin.h file
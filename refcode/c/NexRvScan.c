@@ -0,0 +1,152 @@
+/*
+* Copyright (c) 2020 IAR Systems AB.
+*
+* Permission to use, copy, modify, and distribute this software for any
+* purpose with or without fee is hereby granted, provided that the above
+* copyright notice and this permission notice appear in all copies.
+*
+* THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+* WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+* ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+* WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+* ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+* OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//****************************************************************************
+// File NexRvScan.c - Scanning of Nexus byte stream (idles and message ends)
+
+// Code below is written in plain C-code.
+// It was compiled using VisualC, GNU and IAR C/C++ compiler.
+//  1. Only standard C-types are used.
+//  2. Only few standard C functions used - see notes with "#include <...>"
+//  3. Only non K&R C is 'for (int x' and 'int x;' between instructions.
+//
+// Vector versions are selected by compiler predefined macros (__AVX2__,
+// __SSE2__ or _M_X64). Scalar version can be forced by -DNEXRV_SIMD=0.
+
+#include <string.h> //  For 'memcpy'
+#include <stdint.h> //  For 'uint64_t'
+
+#include "NexRvScan.h"
+
+#ifndef NEXRV_SIMD
+#if defined(__AVX2__)
+#define NEXRV_SIMD 2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NEXRV_SIMD 1
+#else
+#define NEXRV_SIMD 0
+#endif
+#endif
+
+#if NEXRV_SIMD >= 2
+#include <immintrin.h>  //  For '_mm256_...'
+#elif NEXRV_SIMD >= 1
+#include <emmintrin.h>  //  For '_mm_...'
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>     //  For '_BitScanForward'
+#endif
+
+// Index of lowest set bit ('m' must not be 0)
+static unsigned int LowBit(uint64_t m)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned int)__builtin_ctzll(m);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long i;
+  _BitScanForward64(&i, m);
+  return (unsigned int)i;
+#else
+  unsigned int i = 0;
+  while ((m & 1) == 0)
+  {
+    m >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+
+// Load 8 bytes as little-endian 64-bit word (first byte is in bits 0..7)
+static uint64_t Load64(const unsigned char *p)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_M_X64) || defined(_M_IX86)
+  uint64_t w;
+  memcpy(&w, p, 8);
+  return w;
+#else
+  uint64_t w = 0;
+  for (int k = 7; k >= 0; k--) w = (w << 8) | p[k];
+  return w;
+#endif
+}
+
+#define SCAN_LSB  0x0101010101010101ull
+
+size_t NexRvScan_Idle(const unsigned char *p, size_t n)
+{
+  size_t i = 0;
+#if NEXRV_SIMD >= 2
+  const __m256i ff32 = _mm256_set1_epi8((char)0xFF);
+  for (; i + 32 <= n; i += 32)
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+    unsigned int m = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, ff32));
+    if (m != 0xFFFFFFFFu) return i + LowBit(~m);
+  }
+#endif
+#if NEXRV_SIMD >= 1
+  const __m128i ff16 = _mm_set1_epi8((char)0xFF);
+  for (; i + 16 <= n; i += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+    unsigned int m = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, ff16));
+    if (m != 0xFFFFu) return i + LowBit(~m & 0xFFFFu);
+  }
+#endif
+  for (; i + 8 <= n; i += 8)
+  {
+    uint64_t w = ~Load64(p + i);    // Idle bytes are 0 now
+    if (w != 0) return i + LowBit(w) / 8;
+  }
+  while (i < n && p[i] == 0xFF) i++;
+  return i;
+}
+
+size_t NexRvScan_End(const unsigned char *p, size_t n)
+{
+  size_t i = 0;
+#if NEXRV_SIMD >= 2
+  const __m256i m3_32 = _mm256_set1_epi8(3);
+  for (; i + 32 <= n; i += 32)
+  {
+    __m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(p + i)), m3_32);
+    unsigned int m = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, m3_32));
+    if (m != 0) return i + LowBit(m);
+  }
+#endif
+#if NEXRV_SIMD >= 1
+  const __m128i m3_16 = _mm_set1_epi8(3);
+  for (; i + 16 <= n; i += 16)
+  {
+    __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i *)(p + i)), m3_16);
+    unsigned int m = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, m3_16));
+    if (m != 0) return i + LowBit(m);
+  }
+#endif
+  for (; i + 8 <= n; i += 8)
+  {
+    uint64_t w = Load64(p + i);
+    w = w & (w >> 1) & SCAN_LSB;    // Bit 0 of each byte is set if MSEO='11'
+    if (w != 0) return i + LowBit(w) / 8;
+  }
+  while (i < n && (p[i] & 0x3) != 0x3) i++;
+  return i;
+}
+
+//****************************************************************************
+// End of NexRvScan.c file
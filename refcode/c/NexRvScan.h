@@ -0,0 +1,39 @@
+/*
+* Copyright (c) 2020 IAR Systems AB.
+*
+* Permission to use, copy, modify, and distribute this software for any
+* purpose with or without fee is hereby granted, provided that the above
+* copyright notice and this permission notice appear in all copies.
+*
+* THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+* WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+* MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+* ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+* WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+* ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+* OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+//****************************************************************************
+// File NexRvScan.h  - Scanning of Nexus byte stream (idles and message ends)
+
+// Real captures include long runs of idle bytes (0xFF). These functions
+// skip idles and find ends of messages (MSEO='11') many bytes at a time.
+// SSE2 (or AVX2 if compiled with -mavx2) is used on x86, otherwise bytes
+// are checked 8 at a time in 64-bit words.
+
+#ifndef NEXRVSCAN_H
+#define NEXRVSCAN_H
+
+#include <stddef.h> // For size_t
+
+// Number of idle bytes (0xFF) at 'p' (up to 'n')
+extern size_t NexRvScan_Idle(const unsigned char *p, size_t n);
+
+// Offset of first byte with MSEO='11' (end of message or idle) at 'p' ('n' if none)
+extern size_t NexRvScan_End(const unsigned char *p, size_t n);
+
+#endif  // NEXRVSCAN_H
+
+//****************************************************************************
+// End of NexRvScan.h file